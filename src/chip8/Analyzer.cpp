@@ -0,0 +1,173 @@
+#include <chip8/Analyzer.h>
+#include <chip8/Disassembler.h>
+
+namespace chip8
+{
+	namespace
+	{
+		static constexpr uint MaxJumpTable = 128;
+
+		bool IsValid(u16 op)
+		{ return Disassemble(op).compare(0, 7, "invalid") != 0; }
+
+		bool IsSkip(u16 op)
+		{
+			switch(op >> 12)
+			{
+			case 0x3: case 0x4:
+				return true;
+			case 0x5: case 0x9:
+				return (op & 0x0f) == 0;
+			case 0xe:
+				return (op & 0xff) == 0x9e || (op & 0xff) == 0xa1;
+			default:
+				return false;
+			}
+		}
+
+		bool IsExit(u16 op)
+		{ return op == 0x0000 || op == 0x00ee || op == 0x00fd; }
+	}
+
+	Analyzer::Analyzer(const u8 *memory, uint begin, uint end):
+		_memory(memory), _begin(begin), _end(end), _code(0x10000)
+	{ }
+
+	uint Analyzer::Size(u16 addr) const
+	{ return chip8::GetInstructionSize(Read16(addr)); }
+
+	void Analyzer::Analyze(u16 entry)
+	{
+		Trace(entry);
+		BuildBlocks();
+	}
+
+	void Analyzer::Trace(u16 entry)
+	{
+		std::vector<u16> queue = { entry };
+		_leaders.insert(entry);
+
+		auto branch = [&](u16 target)
+		{
+			if (!Inside(target))
+				return;
+			_leaders.insert(target);
+			if (!_code[target])
+				queue.push_back(target);
+		};
+
+		while(!queue.empty())
+		{
+			u16 addr = queue.back();
+			queue.pop_back();
+
+			while(Inside(addr) && !_code[addr])
+			{
+				u16 op = Read16(addr);
+				if (!IsValid(op))
+					break;
+
+				_code[addr] = true;
+				u16 next = addr + Size(addr);
+				u16 nnn = op & 0x0fff;
+
+				if (IsExit(op))
+					break;
+
+				switch(op >> 12)
+				{
+				case 0x1:
+					branch(nnn);
+					break;
+				case 0x2:
+					_calls.insert(nnn);
+					branch(nnn);
+					branch(next); //return site
+					break;
+				case 0xa:
+					_dataLabels.insert(nnn);
+					break;
+				case 0xb:
+					//jump0 into table of jumps, take every entry as long as it looks like a jump
+					for(uint i = 0; i < MaxJumpTable && Inside(nnn + i * 2) && (Read16(nnn + i * 2) >> 12) == 0x1; ++i)
+						branch(nnn + i * 2);
+					if (!Inside(nnn) || (Read16(nnn) >> 12) != 0x1)
+						branch(nnn);
+					break;
+				case 0xf:
+					if (op == 0xf000 && Inside(addr + 2))
+						_dataLabels.insert(Read16(addr + 2));
+					break;
+				}
+
+				if ((op >> 12) == 0x1 || (op >> 12) == 0x2 || (op >> 12) == 0xb)
+					break;
+
+				if (IsSkip(op))
+				{
+					branch(next);
+					if (Inside(next))
+						branch(next + Size(next));
+					break;
+				}
+				addr = next;
+			}
+		}
+	}
+
+	void Analyzer::BuildBlocks()
+	{
+		for(u16 leader : _leaders)
+		{
+			if (!_code[leader])
+				continue;
+
+			Block block = { leader, leader, { }, false };
+			u16 addr = leader;
+			while(true)
+			{
+				u16 op = Read16(addr);
+				u16 next = addr + Size(addr);
+				block.End = next;
+
+				if (IsExit(op))
+				{
+					block.Dynamic = op == 0x00ee;
+					break;
+				}
+				u8 group = op >> 12;
+				if (group == 0x1)
+				{
+					block.Successors.push_back(op & 0x0fff);
+					break;
+				}
+				if (group == 0x2)
+				{
+					block.Successors.push_back(op & 0x0fff);
+					block.Successors.push_back(next);
+					break;
+				}
+				if (group == 0xb)
+				{
+					block.Dynamic = true;
+					break;
+				}
+				if (IsSkip(op))
+				{
+					block.Successors.push_back(next);
+					if (Inside(next))
+						block.Successors.push_back(next + Size(next));
+					break;
+				}
+				if (!Inside(next) || !_code[next] || _leaders.count(next))
+				{
+					if (Inside(next) && _code[next])
+						block.Successors.push_back(next);
+					break;
+				}
+				addr = next;
+			}
+			_blocks[leader] = block;
+		}
+	}
+}
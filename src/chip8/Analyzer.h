@@ -0,0 +1,70 @@
+#ifndef ANALYZER_H
+#define ANALYZER_H
+
+#include <chip8/types.h>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace chip8
+{
+	///recursive traversal of rom image separating code from data and building control flow graph
+	class Analyzer
+	{
+	public:
+		struct Block
+		{
+			u16					Begin, End;		//[Begin, End) in bytes
+			std::vector<u16>	Successors;		//static successors, call target goes first
+			bool				Dynamic;		//ends with ret or jump0, successors are not known
+		};
+
+	private:
+		const u8 *				_memory;
+		uint					_begin, _end;
+		std::vector<bool>		_code;			//instruction starts
+		std::set<u16>			_leaders;
+		std::set<u16>			_calls;
+		std::set<u16>			_dataLabels;
+		std::map<u16, Block>	_blocks;
+
+		u16 Read16(u16 addr) const
+		{ return (static_cast<u16>(_memory[addr]) << 8) | _memory[static_cast<u16>(addr + 1)]; }
+
+		bool Inside(u16 addr) const
+		{ return addr >= _begin && addr + 1u < _end; }
+
+		uint Size(u16 addr) const;
+		void Trace(u16 entry);
+		void BuildBlocks();
+
+	public:
+		///memory is the whole 64k guest address space, rom occupies [begin, end)
+		Analyzer(const u8 *memory, uint begin, uint end);
+
+		void Analyze(u16 entry);
+
+		bool IsCode(u16 addr) const
+		{ return _code[addr]; }
+
+		bool IsLeader(u16 addr) const
+		{ return _leaders.count(addr); }
+
+		bool IsCall(u16 addr) const
+		{ return _calls.count(addr); }
+
+		bool IsDataLabel(u16 addr) const
+		{ return _dataLabels.count(addr); }
+
+		uint GetInstructionSize(u16 addr) const
+		{ return Size(addr); }
+
+		const std::map<u16, Block> & GetBlocks() const
+		{ return _blocks; }
+
+		uint GetBegin() const	{ return _begin; }
+		uint GetEnd() const		{ return _end; }
+	};
+}
+
+#endif
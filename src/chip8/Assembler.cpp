@@ -0,0 +1,825 @@
+#include <chip8/Assembler.h>
+#include <ctype.h>
+#include <deque>
+#include <map>
+#include <math.h>
+#include <stdexcept>
+#include <stdlib.h>
+
+namespace chip8
+{
+	namespace
+	{
+		static constexpr uint EntryPoint	= 0x200;
+		static constexpr uint MemorySize	= 0x10000;
+
+		struct Token
+		{
+			std::string		Text;
+			uint			Line;
+		};
+
+		struct Macro
+		{
+			std::vector<std::string>	Args;
+			std::vector<Token>			Body;
+			uint						Calls;
+		};
+
+		struct Fixup
+		{
+			enum Kind { Op12, Long16, UnpackHi, UnpackLo };
+
+			Kind			Type;
+			uint			Addr;
+			u8				Nibble;
+			Token			Name;
+		};
+
+		struct Loop
+		{
+			uint				Begin;
+			std::vector<uint>	Breaks;
+		};
+
+		class Compiler
+		{
+			const std::string &				_name;
+			std::deque<Token>				_tokens;
+			uint							_line;
+
+			std::vector<u8>					_memory;
+			uint							_here;
+			uint							_end;
+			bool							_entryJump;
+
+			std::map<std::string, uint>		_labels;
+			std::map<std::string, double>	_constants;
+			std::map<std::string, u8>		_aliases;
+			std::map<std::string, Macro>	_macros;
+			std::vector<Fixup>				_fixups;
+			std::vector<uint>				_branches;
+			std::vector<Loop>				_loops;
+
+			[[noreturn]] void Error(const std::string &message, uint line)
+			{ throw std::runtime_error(_name + ":" + std::to_string(line) + ": " + message); }
+
+			[[noreturn]] void Error(const std::string &message)
+			{ Error(message, _line); }
+
+			void Tokenize(const std::string &source)
+			{
+				uint line = 1;
+				size_t pos = 0, n = source.size();
+				while(pos < n)
+				{
+					char c = source[pos];
+					if (c == '\n')
+					{
+						++line;
+						++pos;
+					}
+					else if (isspace(static_cast<u8>(c)))
+						++pos;
+					else if (c == '#')
+					{
+						while(pos < n && source[pos] != '\n')
+							++pos;
+					}
+					else if (c == '"')
+					{
+						auto end = source.find('"', pos + 1);
+						if (end == source.npos)
+							Error("unterminated string", line);
+						_tokens.push_back(Token { source.substr(pos, end + 1 - pos), line });
+						pos = end + 1;
+					}
+					else
+					{
+						size_t begin = pos;
+						while(pos < n && !isspace(static_cast<u8>(source[pos])))
+							++pos;
+						_tokens.push_back(Token { source.substr(begin, pos - begin), line });
+					}
+				}
+			}
+
+			bool Empty() const
+			{ return _tokens.empty(); }
+
+			const std::string &Peek() const
+			{
+				static const std::string eof;
+				return _tokens.empty()? eof: _tokens.front().Text;
+			}
+
+			Token NextToken()
+			{
+				if (_tokens.empty())
+					Error("unexpected end of source");
+				Token token = _tokens.front();
+				_tokens.pop_front();
+				_line = token.Line;
+				return token;
+			}
+
+			std::string Next()
+			{ return NextToken().Text; }
+
+			void Expect(const std::string &text)
+			{
+				auto token = Next();
+				if (token != text)
+					Error("expected '" + text + "', got '" + token + "'");
+			}
+
+			void Emit(u8 value)
+			{
+				if (_here >= MemorySize)
+					Error("program does not fit into 64k");
+				_memory[_here++] = value;
+				if (_here > _end)
+					_end = _here;
+			}
+
+			void Op(u16 op)
+			{
+				Emit(op >> 8);
+				Emit(op & 0xff);
+			}
+
+			void PatchJump(uint addr, uint target)
+			{
+				if (target > 0xfff)
+					Error("jump target is out of 12-bit address space");
+				_memory[addr]		= 0x10 | (target >> 8);
+				_memory[addr + 1]	= target & 0xff;
+			}
+
+			static bool ParseNumber(const std::string &text, double &value)
+			{
+				if (text.empty())
+					return false;
+				bool negative = text[0] == '-';
+				std::string digits = text.substr(negative? 1: 0);
+				int base = 10;
+				if (digits.size() > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))
+					base = 16;
+				else if (digits.size() > 2 && digits[0] == '0' && (digits[1] == 'b' || digits[1] == 'B'))
+					base = 2;
+				if (base != 10)
+					digits = digits.substr(2);
+				if (digits.empty())
+					return false;
+				char *end;
+				long number = strtol(digits.c_str(), &end, base);
+				if (*end != 0)
+					return false;
+				value = negative? -number: number;
+				return true;
+			}
+
+			bool IsRegister(const std::string &text, u8 &reg) const
+			{
+				auto alias = _aliases.find(text);
+				if (alias != _aliases.end())
+				{
+					reg = alias->second;
+					return true;
+				}
+				if (text.size() != 2 || (text[0] != 'v' && text[0] != 'V') || !isxdigit(static_cast<u8>(text[1])))
+					return false;
+				char digit = tolower(text[1]);
+				reg = digit <= '9'? digit - '0': digit - 'a' + 10;
+				return true;
+			}
+
+			u8 Register()
+			{
+				auto token = Next();
+				u8 reg;
+				if (!IsRegister(token, reg))
+					Error("expected register, got '" + token + "'");
+				return reg;
+			}
+
+			static bool IsIdentifier(const std::string &text)
+			{
+				if (text.empty() || !(isalpha(static_cast<u8>(text[0])) || text[0] == '_' || text[0] == '-'))
+					return false;
+				for(char c : text)
+					if (!(isalnum(static_cast<u8>(c)) || c == '_' || c == '-'))
+						return false;
+				return true;
+			}
+
+			///constant, defined label or literal
+			bool Lookup(const std::string &text, double &value) const
+			{
+				if (ParseNumber(text, value))
+					return true;
+				auto constant = _constants.find(text);
+				if (constant != _constants.end())
+				{
+					value = constant->second;
+					return true;
+				}
+				auto label = _labels.find(text);
+				if (label != _labels.end())
+				{
+					value = label->second;
+					return true;
+				}
+				return false;
+			}
+
+			double Term()
+			{
+				auto token = Next();
+				if (token == "(")
+				{
+					double value = Expression();
+					Expect(")");
+					return value;
+				}
+				if (token == "-")		return -Term();
+				if (token == "~")		return ~static_cast<long>(Term());
+				if (token == "!")		return Term() == 0? 1: 0;
+				if (token == "sin")		return sin(Term());
+				if (token == "cos")		return cos(Term());
+				if (token == "tan")		return tan(Term());
+				if (token == "exp")		return exp(Term());
+				if (token == "log")		return log(Term());
+				if (token == "abs")		return fabs(Term());
+				if (token == "sqrt")	return sqrt(Term());
+				if (token == "sign")	{ double v = Term(); return v > 0? 1: v < 0? -1: 0; }
+				if (token == "ceil")	return ceil(Term());
+				if (token == "floor")	return floor(Term());
+				if (token == "@")
+				{
+					long addr = static_cast<long>(Term());
+					if (addr < 0 || addr >= static_cast<long>(MemorySize))
+						Error("address out of range in '@'");
+					return _memory[addr];
+				}
+				if (token == "HERE")	return _here;
+				if (token == "PI")		return M_PI;
+				if (token == "E")		return M_E;
+
+				double value;
+				if (!Lookup(token, value))
+					Error("undefined name '" + token + "' in expression");
+				return value;
+			}
+
+			///no precedence, evaluated right to left as in Octo
+			double Expression()
+			{
+				double lhs = Term();
+				auto op = Peek();
+				if (op == "}" || op == ")" || op.empty())
+					return lhs;
+				Next();
+				double rhs = Expression();
+				long l = static_cast<long>(lhs), r = static_cast<long>(rhs);
+				if (op == "+")		return lhs + rhs;
+				if (op == "-")		return lhs - rhs;
+				if (op == "*")		return lhs * rhs;
+				if (op == "/")		{ if (rhs == 0) Error("division by zero"); return lhs / rhs; }
+				if (op == "%")		{ if (r == 0) Error("division by zero"); return l % r; }
+				if (op == "&")		return l & r;
+				if (op == "|")		return l | r;
+				if (op == "^")		return l ^ r;
+				if (op == "<<")		return l << r;
+				if (op == ">>")		return l >> r;
+				if (op == "pow")	return pow(lhs, rhs);
+				if (op == "min")	return lhs < rhs? lhs: rhs;
+				if (op == "max")	return lhs > rhs? lhs: rhs;
+				if (op == "<")		return lhs < rhs;
+				if (op == "<=")		return lhs <= rhs;
+				if (op == "==")		return lhs == rhs;
+				if (op == "!=")		return lhs != rhs;
+				if (op == ">=")		return lhs >= rhs;
+				if (op == ">")		return lhs > rhs;
+				Error("unknown operator '" + op + "'");
+			}
+
+			double Braced()
+			{
+				Expect("{");
+				double value = Expression();
+				Expect("}");
+				return value;
+			}
+
+			long Value(long min, long max)
+			{
+				double value;
+				if (Peek() == "{")
+					value = Braced();
+				else
+				{
+					auto token = Next();
+					if (!Lookup(token, value))
+						Error("expected value, got '" + token + "'");
+				}
+				long result = static_cast<long>(floor(value));
+				if (result < min || result > max)
+					Error("value " + std::to_string(result) + " is out of range");
+				return result;
+			}
+
+			u8 Byte()
+			{ return Value(-128, 255) & 0xff; }
+
+			u8 Nibble()
+			{ return Value(0, 15); }
+
+			///address operand, undefined names become forward references patched at the end
+			uint Address(Fixup::Kind type, uint max, u8 nibble = 0)
+			{
+				if (Peek() == "{")
+					return Value(0, max);
+				auto token = NextToken();
+				double value;
+				if (Lookup(token.Text, value))
+				{
+					if (value < 0 || value > max)
+						Error("address '" + token.Text + "' is out of range");
+					return value;
+				}
+				if (!IsIdentifier(token.Text))
+					Error("expected address, got '" + token.Text + "'");
+				_fixups.push_back(Fixup { type, _here, nibble, token });
+				return 0;
+			}
+
+			void DefineLabel(const std::string &name, uint addr)
+			{
+				if (!IsIdentifier(name))
+					Error("invalid label name '" + name + "'");
+				if (_labels.count(name) || _constants.count(name))
+					Error("name '" + name + "' is already defined");
+				_labels[name] = addr;
+			}
+
+			void Label()
+			{
+				auto name = Next();
+				//main right after the reserved entry jump: drop the jump
+				if (name == "main" && _entryJump && _here == EntryPoint + 2)
+				{
+					_entryJump = false;
+					_here = _end = EntryPoint;
+					for(auto &label : _labels)
+						if (label.second == EntryPoint + 2)
+							label.second = EntryPoint;
+				}
+				DefineLabel(name, _here);
+			}
+
+			///skip op that skips the next instruction when condition is true, may emit vf comparison first
+			u16 Condition()
+			{
+				u8 x = Register();
+				auto cmp = Next();
+				if (cmp == "key" || cmp == "-key")
+				{
+					return (cmp == "key"? 0xe09e: 0xe0a1) | (x << 8);
+				}
+
+				if (cmp == "==" || cmp == "!=")
+				{
+					bool equal = cmp == "==";
+					u8 y;
+					if (IsRegister(Peek(), y))
+					{
+						Next();
+						return (equal? 0x5000: 0x9000) | (x << 8) | (y << 4);
+					}
+					return (equal? 0x3000: 0x4000) | (x << 8) | Byte();
+				}
+
+				//vf = flag of x - y or y - x, comparison turns into vf == 0 or vf == 1
+				bool xMinusY, flag;
+				if (cmp == "<")			{ xMinusY = true;	flag = false; }
+				else if (cmp == ">=")	{ xMinusY = true;	flag = true; }
+				else if (cmp == ">")	{ xMinusY = false;	flag = false; }
+				else if (cmp == "<=")	{ xMinusY = false;	flag = true; }
+				else
+					Error("unknown comparison '" + cmp + "'");
+
+				u8 y;
+				if (IsRegister(Peek(), y))
+				{
+					Next();
+					Op(0x8f00 | (y << 4));
+				}
+				else
+					Op(0x6f00 | Byte());
+				Op((xMinusY? 0x8f07: 0x8f05) | (x << 4));
+				return 0x3f00 | (flag? 1: 0);
+			}
+
+			static u16 Negate(u16 skip)
+			{
+				switch(skip >> 12)
+				{
+				case 0x3: case 0x4:	return skip ^ 0x7000;
+				case 0x5: case 0x9:	return skip ^ 0xc000;
+				default:			return (skip & 0xff00) | ((skip & 0xff) == 0x9e? 0xa1: 0x9e);
+				}
+			}
+
+			void If()
+			{
+				auto skip = Condition();
+				auto mode = Next();
+				if (mode == "then")
+					Op(Negate(skip)); //skip the following statement when condition is false
+				else if (mode == "begin")
+				{
+					Op(skip);
+					_branches.push_back(_here);
+					Op(0x1000);
+				}
+				else
+					Error("expected 'then' or 'begin', got '" + mode + "'");
+			}
+
+			void Assign(u8 x)
+			{
+				auto src = Next();
+				u8 y;
+				if (src == "key")
+					Op(0xf00a | (x << 8));
+				else if (src == "delay")
+					Op(0xf007 | (x << 8));
+				else if (src == "random")
+					Op(0xc000 | (x << 8) | Byte());
+				else if (IsRegister(src, y))
+					Op(0x8000 | (x << 8) | (y << 4));
+				else
+				{
+					_tokens.push_front(Token { src, _line });
+					Op(0x6000 | (x << 8) | Byte());
+				}
+			}
+
+			void RegisterOp(u8 x)
+			{
+				auto op = Next();
+				if (op == ":=")
+					return Assign(x);
+
+				u8 y;
+				bool reg = IsRegister(Peek(), y);
+				if (reg)
+					Next();
+
+				if (op == "+=" && !reg)
+					Op(0x7000 | (x << 8) | Byte());
+				else if (op == "-=" && !reg)
+					Op(0x7000 | (x << 8) | ((-Value(-255, 255)) & 0xff));
+				else if (!reg)
+					Error("expected register after '" + op + "'");
+				else
+				{
+					u8 z;
+					if (op == "|=")			z = 0x1;
+					else if (op == "&=")	z = 0x2;
+					else if (op == "^=")	z = 0x3;
+					else if (op == "+=")	z = 0x4;
+					else if (op == "-=")	z = 0x5;
+					else if (op == ">>=")	z = 0x6;
+					else if (op == "=-")	z = 0x7;
+					else if (op == "<<=")	z = 0xe;
+					else
+						Error("unknown operator '" + op + "'");
+					Op(0x8000 | (x << 8) | (y << 4) | z);
+				}
+			}
+
+			void IndexOp()
+			{
+				auto op = Next();
+				if (op == "+=")
+				{
+					Op(0xf01e | (Register() << 8));
+					return;
+				}
+				if (op != ":=")
+					Error("unknown operator 'i " + op + "'");
+
+				auto src = Peek();
+				if (src == "hex")
+				{
+					Next();
+					Op(0xf029 | (Register() << 8));
+				}
+				else if (src == "bighex")
+				{
+					Next();
+					Op(0xf030 | (Register() << 8));
+				}
+				else if (src == "long")
+				{
+					Next();
+					Op(0xf000);
+					uint addr = Address(Fixup::Long16, 0xffff);
+					Op(addr);
+				}
+				else
+					Op(0xa000 | Address(Fixup::Op12, 0xfff));
+			}
+
+			void RangeOp(u16 single, u16 range)
+			{
+				u8 x = Register();
+				if (Peek() == "-")
+				{
+					Next();
+					u8 y = Register();
+					Op(range | (x << 8) | (y << 4));
+				}
+				else
+					Op(single | (x << 8));
+			}
+
+			void DefineMacro()
+			{
+				auto name = Next();
+				Macro macro { {}, {}, 0 };
+				while(Peek() != "{")
+					macro.Args.push_back(Next());
+				Next();
+				for(int depth = 1; ; )
+				{
+					auto token = NextToken();
+					if (token.Text == "{")
+						++depth;
+					else if (token.Text == "}" && --depth == 0)
+						break;
+					macro.Body.push_back(token);
+				}
+				_macros[name] = macro;
+			}
+
+			void Expand(Macro &macro)
+			{
+				std::map<std::string, std::string> args;
+				for(auto &arg : macro.Args)
+					args[arg] = Next();
+				args["CALLS"] = std::to_string(macro.Calls++);
+				for(auto i = macro.Body.rbegin(); i != macro.Body.rend(); ++i)
+				{
+					auto arg = args.find(i->Text);
+					_tokens.push_front(Token { arg != args.end()? arg->second: i->Text, _line });
+				}
+			}
+
+			void Directive(const std::string &directive)
+			{
+				if (directive == ":")
+					Label();
+				else if (directive == ":const")
+				{
+					auto name = Next();
+					if (!IsIdentifier(name) || _labels.count(name) || _constants.count(name))
+						Error("invalid or duplicate constant name '" + name + "'");
+					_constants[name] = Value(-0x10000, 0x10000);
+				}
+				else if (directive == ":calc")
+				{
+					auto name = Next();
+					if (!IsIdentifier(name) || _labels.count(name))
+						Error("invalid calc name '" + name + "'");
+					_constants[name] = Braced();
+				}
+				else if (directive == ":alias")
+				{
+					auto name = Next();
+					_aliases[name] = Register();
+				}
+				else if (directive == ":unpack")
+				{
+					u8 nibble = 0;
+					if (Peek() == "long")
+						Next();
+					else
+						nibble = Nibble();
+					Emit(0x60);
+					size_t fixups = _fixups.size();
+					uint addr = Address(Fixup::UnpackHi, nibble? 0xfff: 0xffff, nibble);
+					Emit((nibble << 4) | (addr >> 8));
+					Emit(0x61);
+					if (_fixups.size() != fixups)
+					{
+						auto fixup = _fixups.back();
+						fixup.Type = Fixup::UnpackLo;
+						fixup.Addr = _here;
+						_fixups.push_back(fixup);
+					}
+					Emit(addr & 0xff);
+				}
+				else if (directive == ":next")
+					DefineLabel(Next(), _here + 1);
+				else if (directive == ":org")
+					_here = Value(0, MemorySize - 1);
+				else if (directive == ":byte")
+					Emit(Byte());
+				else if (directive == ":call")
+					Op(0x2000 | Address(Fixup::Op12, 0xfff));
+				else if (directive == ":macro")
+					DefineMacro();
+				else if (directive == ":assert")
+				{
+					std::string message = "assertion failed";
+					if (!Peek().empty() && Peek()[0] == '"')
+						message += ": " + Next();
+					if (Braced() == 0)
+						Error(message);
+				}
+				else if (directive == ":breakpoint" || directive == ":proto")
+					Next();
+				else if (directive == ":monitor")
+				{
+					Next();
+					Next();
+				}
+				else
+					Error("unknown directive '" + directive + "'");
+			}
+
+			void Statement()
+			{
+				auto token = Next();
+				u8 x;
+				double number;
+
+				if (token[0] == ':')
+					Directive(token);
+				else if (_macros.count(token))
+					Expand(_macros[token]);
+				else if (IsRegister(token, x))
+					RegisterOp(x);
+				else if (token == "i")
+					IndexOp();
+				else if (token == "return" || token == ";")	Op(0x00ee);
+				else if (token == "clear")			Op(0x00e0);
+				else if (token == "exit")			Op(0x00fd);
+				else if (token == "lores")			Op(0x00fe);
+				else if (token == "hires")			Op(0x00ff);
+				else if (token == "scroll-down")	Op(0x00c0 | Nibble());
+				else if (token == "scroll-up")		Op(0x00d0 | Nibble());
+				else if (token == "scroll-right")	Op(0x00fb);
+				else if (token == "scroll-left")	Op(0x00fc);
+				else if (token == "jump")			Op(0x1000 | Address(Fixup::Op12, 0xfff));
+				else if (token == "jump0")			Op(0xb000 | Address(Fixup::Op12, 0xfff));
+				else if (token == "sprite")
+				{
+					u8 rx = Register();
+					u8 ry = Register();
+					Op(0xd000 | (rx << 8) | (ry << 4) | Nibble());
+				}
+				else if (token == "load")			RangeOp(0xf065, 0x5003);
+				else if (token == "save")			RangeOp(0xf055, 0x5002);
+				else if (token == "saveflags")		Op(0xf075 | (Register() << 8));
+				else if (token == "loadflags")		Op(0xf085 | (Register() << 8));
+				else if (token == "bcd")			Op(0xf033 | (Register() << 8));
+				else if (token == "plane")			Op(0xf001 | (Nibble() << 8));
+				else if (token == "audio")			Op(0xf002);
+				else if (token == "delay" || token == "buzzer" || token == "pitch")
+				{
+					Expect(":=");
+					u8 rx = Register();
+					Op((token == "delay"? 0xf015: token == "buzzer"? 0xf018: 0xf03a) | (rx << 8));
+				}
+				else if (token == "if")
+					If();
+				else if (token == "else")
+				{
+					if (_branches.empty())
+						Error("'else' without 'if ... begin'");
+					uint jump = _here;
+					Op(0x1000);
+					PatchJump(_branches.back(), _here);
+					_branches.back() = jump;
+				}
+				else if (token == "end")
+				{
+					if (_branches.empty())
+						Error("'end' without 'if ... begin'");
+					PatchJump(_branches.back(), _here);
+					_branches.pop_back();
+				}
+				else if (token == "loop")
+					_loops.push_back(Loop { _here, {} });
+				else if (token == "while")
+				{
+					if (_loops.empty())
+						Error("'while' outside of loop");
+					Op(Condition());
+					_loops.back().Breaks.push_back(_here);
+					Op(0x1000);
+				}
+				else if (token == "again")
+				{
+					if (_loops.empty())
+						Error("'again' without 'loop'");
+					auto loop = _loops.back();
+					_loops.pop_back();
+					Op(0x1000);
+					PatchJump(_here - 2, loop.Begin);
+					for(uint addr : loop.Breaks)
+						PatchJump(addr, _here);
+				}
+				else if (ParseNumber(token, number))
+				{
+					if (number < -128 || number > 255)
+						Error("byte value " + token + " is out of range");
+					Emit(static_cast<long>(number) & 0xff);
+				}
+				else if (token == "{")
+				{
+					_tokens.push_front(Token { token, _line });
+					Emit(Byte());
+				}
+				else if (_constants.count(token))
+					Error("constant '" + token + "' used as statement");
+				else if (IsIdentifier(token))
+				{
+					//label call, possibly forward
+					_tokens.push_front(Token { token, _line });
+					Op(0x2000 | Address(Fixup::Op12, 0xfff));
+				}
+				else
+					Error("unexpected '" + token + "'");
+			}
+
+			void Resolve()
+			{
+				for(auto &fixup : _fixups)
+				{
+					auto label = _labels.find(fixup.Name.Text);
+					if (label == _labels.end())
+						Error("undefined name '" + fixup.Name.Text + "'", fixup.Name.Line);
+					uint addr = label->second;
+					u8 *dst = &_memory[fixup.Addr];
+					switch(fixup.Type)
+					{
+					case Fixup::Op12:
+						if (addr > 0xfff)
+							Error("label '" + fixup.Name.Text + "' is out of 12-bit address space, use 'i := long'", fixup.Name.Line);
+						dst[0] |= addr >> 8;
+						dst[1] = addr & 0xff;
+						break;
+					case Fixup::Long16:
+						dst[0] = addr >> 8;
+						dst[1] = addr & 0xff;
+						break;
+					case Fixup::UnpackHi:
+						if (fixup.Nibble && addr > 0xfff)
+							Error("label '" + fixup.Name.Text + "' is out of 12-bit address space, use ':unpack long'", fixup.Name.Line);
+						dst[0] = (fixup.Nibble << 4) | (addr >> 8);
+						break;
+					case Fixup::UnpackLo:
+						dst[0] = addr & 0xff;
+						break;
+					}
+				}
+			}
+
+		public:
+			Compiler(const std::string &name):
+				_name(name), _line(1), _memory(MemorySize + 2), _here(EntryPoint + 2), _end(EntryPoint + 2), _entryJump(true)
+			{ }
+
+			std::vector<u8> Compile(const std::string &source)
+			{
+				Tokenize(source);
+				while(!Empty())
+					Statement();
+
+				if (!_branches.empty())
+					Error("'if ... begin' without 'end'");
+				if (!_loops.empty())
+					Error("'loop' without 'again'");
+
+				auto main = _labels.find("main");
+				if (main == _labels.end())
+					Error("program has no 'main' label");
+				if (_entryJump)
+					PatchJump(EntryPoint, main->second);
+				Resolve();
+				return std::vector<u8>(_memory.begin() + EntryPoint, _memory.begin() + _end);
+			}
+		};
+	}
+
+	std::vector<u8> Assembler::Assemble(const std::string &source, const std::string &name)
+	{
+		Compiler compiler(name);
+		return compiler.Compile(source);
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <chip8/types.h>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///Octo assembler: labels, :const, :alias, :unpack, :next, :org, :byte, :call, :macro, :calc, :assert,
+	///structured if/loop and XO-CHIP instructions including long i assignment
+	struct Assembler
+	{
+		///bumped on every change affecting output, part of compiled rom cache key
+		static constexpr uint Version = 1;
+
+		///returns rom image starting at 0x200, throws runtime_error with name:line prefix
+		static std::vector<u8> Assemble(const std::string &source, const std::string &name = "source");
+	};
+}
+
+#endif
@@ -6,6 +6,12 @@ namespace chip8
 	void Audio::UpdateCurrentBit()
 	{ _currentBit = _memory.Get(_baseAddr + (_currentBitOffset >> 3)) & (0x80 >> (_currentBitOffset & 0x07)); }
 
+	void Audio::GetPattern(u8 *pattern) const
+	{
+		for(uint i = 0; i < PatternSize; ++i)
+			pattern[i] = _memory.Get(_baseAddr + i);
+	}
+
 	void Audio::Tick(uint freq)
 	{
 		_offset += SamplingFreq;
@@ -1,6 +1,7 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#include <chip8/State.h>
 #include <chip8/types.h>
 #include <random>
 
@@ -9,6 +10,10 @@ namespace chip8
 	class Memory;
 	class Audio
 	{
+	public:
+		static constexpr uint	PatternSize		= 16;
+
+	private:
 		static constexpr uint	SamplingFreq	= 4000;
 		static constexpr s16	VolumeMin		= 29000;
 		static constexpr s16	VolumeMax		= 30000;
@@ -33,9 +38,31 @@ namespace chip8
 		void SetBaseAddr(u16 addr)
 		{ _baseAddr = addr; _offset = 0; _currentBitOffset = 0; UpdateCurrentBit(); }
 
+		void Seed(u32 seed)
+		{ _randomGenerator.seed(seed); _randomDistribution.reset(); }
+
 		bool GetCurrentBit() const
 		{ return _currentBit; }
 
+		///copies 128 bit pattern currently played
+		void GetPattern(u8 *pattern) const;
+
+		void SaveState(StateWriter &writer) const
+		{
+			writer.Write16(_baseAddr);
+			writer.Write32(_offset);
+			writer.Write8(_currentBitOffset);
+			writer.Write8(_currentBit);
+		}
+
+		void LoadState(StateReader &reader)
+		{
+			_baseAddr = reader.Read16();
+			_offset = reader.Read32();
+			_currentBitOffset = reader.Read8();
+			_currentBit = reader.Read8();
+		}
+
 		void Generate(uint freq, s16 *samples, uint n);
 	};
 };
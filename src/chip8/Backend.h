@@ -3,6 +3,7 @@
 
 #include <chip8/types.h>
 #include <algorithm>
+#include <chrono>
 
 namespace chip8
 {
@@ -13,6 +14,12 @@ namespace chip8
 	{
 	public:
 		virtual ~Backend() { }
+		///called between execution slices of a frame, key changes made up to time become visible to GetKeyState
+		virtual void PollInput(std::chrono::steady_clock::time_point time) { }
+		///called every frame, even if rendering is elided: input, window and connection events
+		///returns false if backend wants to quit, fb.Invalidate() forces the frame to be rendered
+		virtual bool ProcessEvents(Framebuffer & fb) { return true; }
+		///presents fb, skipped for frames without changes or when running behind schedule
 		virtual bool Render(Framebuffer & fb) = 0;
 		virtual bool GetKeyState(u8 index) = 0;
 		virtual void SetAudio(Audio *audio) = 0;
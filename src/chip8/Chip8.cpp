@@ -2,22 +2,21 @@
 #include <chip8/Config.h>
 #include <chip8/String.h>
 #include <chip8/Backend.h>
+#include <chip8/Debugger.h>
+#include <chip8/Profiler.h>
+#include <chip8/Hash.h>
+#include <chip8/Metrics.h>
+#include <chip8/State.h>
+#include <chip8/StaticProgram.h>
+#include <chip8/Timeline.h>
+#include <chip8/Tracer.h>
 #include <chrono>
+#include <sstream>
 #include <string>
 #include <stdexcept>
 #include <thread>
 #include <stdio.h>
-
-//make runtime option?
-#define LOG_INSTRUCTIONS 0
-
-#if LOG_INSTRUCTIONS
-#	define TRACE(...) do { printf("%04x: ", _pc - 2); printf(__VA_ARGS__); printf("\n"); } while(false)
-#	define TRACEI(...) do { printf("%04x: %04x ", _pc - 2, op); printf(__VA_ARGS__); printf("\n"); } while(false)
-#else
-#	define TRACE(...)
-#	define TRACEI(...)
-#endif
+#include <string.h>
 
 #define LOG_DELAY_LOOPS 0
 
@@ -27,6 +26,11 @@ namespace chip8
 	{
 		u16 Pack16(u8 h, u8 l)
 		{ return (static_cast<u16>(h) << 8) | l; }
+
+		using clock = std::chrono::steady_clock;
+
+		u64 ElapsedNs(clock::time_point started)
+		{ return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - started).count(); }
 	}
 
 	Chip8::Chip8(Config & config, Backend & backend):
@@ -34,19 +38,60 @@ namespace chip8
 		_backend(backend),
 		_memory(),
 		_audio(_memory),
+		_profiler(nullptr),
+		_tracer(nullptr),
+		_debugger(nullptr),
+		_coverage(nullptr),
+		_static(nullptr),
+		_haltOnFault(false),
+		_romHash(0),
+		_autoSpeed(false),
+		_idle(false),
+		_scheduler(std::chrono::microseconds(TimerPeriodMs)),
+		_buzzerShown(false),
+		_sliceWaitNs(0),
 		_randomGenerator(std::random_device()()),
 		_randomDistribution(0, 255)
 	{ Reset(); }
 
-	void Chip8::InvalidOp(u16 op)
-	{ Dump(); throw std::runtime_error("invalid instruction " + ToHex(op)); }
+	void Chip8::RaiseFault(Fault fault, u16 op)
+	{
+		_fault = fault;
+		_faultOp = op;
+		if (_haltOnFault)
+		{
+			_running = false;
+			return;
+		}
+		Dump();
+		switch(fault)
+		{
+		case Fault::StackOverflow:	throw std::runtime_error("stack overflow");
+		case Fault::StackUnderflow:	throw std::runtime_error("stack underflow");
+		default:					throw std::runtime_error("invalid instruction " + ToHex(op));
+		}
+	}
 
-	bool Chip8::Tick()
+	void Chip8::Halt()
 	{
-		using clock = std::chrono::high_resolution_clock;
+		_running = false;
+		if (!_haltOnFault)
+			Dump();
+	}
 
-		auto started = clock::now();
+	bool Chip8::CheckInvariants() const
+	{
+		uint w = _framebuffer.GetWidth(), h = _framebuffer.GetHeight();
+		return _sp <= _stack.size() &&
+			w <= Framebuffer::MaxWidth && h <= Framebuffer::MaxHeight && w * h <= Framebuffer::MaxSize &&
+			_inputReg < _reg.size() &&
+			_planes <= 3 &&
+			(_fault == Fault::None || !_running);
+	}
 
+	bool Chip8::AdvanceFrame(uint slices)
+	{
+		Timeline::Zone zone("AdvanceFrame");
 		if (_waitingInput)
 		{
 			bool anyKeyActive = false;
@@ -56,8 +101,6 @@ namespace chip8
 				{
 					_reg.at(_inputReg) = i;
 					anyKeyActive = true;
-					if (!_waitingInputFinished)
-						TRACE("v%x = %u\n", _inputReg, i);
 					_waitingInputFinished = true;
 				}
 			}
@@ -65,7 +108,14 @@ namespace chip8
 				_waitingInput = false;
 		}
 
+		_autoSpeed = _config.Core.AutoSpeed;
+		_idle = false;
 		uint speed = _config.Core.Speed;
+		if (_autoSpeed)
+		{
+			speed = _speedTuner.GetSpeed(speed);
+			_speedTuner.BeginFrame();
+		}
 #if LOG_DELAY_LOOPS
 		for(uint i = 0, lastRead = 0; i < speed; ++i)
 		{
@@ -79,20 +129,30 @@ namespace chip8
 			}
 		}
 #else
-		uint n = speed;
-		while (n-- && !_waitingInput && _running)
+		//slices split the same budget, only key state can differ from running it at once
+		if (_debugger)
+			_debugger->CheckInterrupt();
+		bool debug = _debugger && _debugger->IsActive();
+		slices = std::max(1u, std::min(slices, speed));
+		uint executed = 0;
+		for(uint slice = 0; slice < slices && _running && !_idle; ++slice)
 		{
-			Step();
+			if (slice)
+				SampleInput(slice, slices);
+			uint budget = speed * (slice + 1) / slices - speed * slice / slices;
+			executed += debug? DebugRun(budget): Run(budget);
 		}
+		_instructions += executed;
+		Metrics::Add(Metrics::Counter::Frames);
+		Metrics::Add(Metrics::Counter::Instructions, executed);
+		Metrics::Record(Metrics::Histogram::InstructionsPerFrame, executed);
+		if (_autoSpeed)
+			_speedTuner.EndFrame(_config.Core.Speed, executed, _idle, _waitingInput);
 #endif
 
 		if (!_running)
 			return false;
 
-		bool running = _backend.Render(_framebuffer);
-
-		std::this_thread::sleep_until(started + std::chrono::microseconds((uint)TimerPeriodMs));
-
 		if (_delay)
 			--_delay;
 
@@ -101,11 +161,165 @@ namespace chip8
 			if (--_buzzer == 0)
 				_backend.SetAudio(nullptr);
 		}
+		return true;
+	}
+
+	bool Chip8::Tick()
+	{
+		Timeline::Zone zone("Tick");
+		bool turbo = _config.Core.Turbo;
+		auto started = clock::now();
+		if (!turbo)
+			_scheduler.BeginFrame();
+
+		_sliceWaitNs = 0;
+		if (!AdvanceFrame(_config.Core.Slices))
+			return false;
+		auto executed = clock::now();
+		Metrics::Record(Metrics::Histogram::ExecNs, std::chrono::duration_cast<std::chrono::nanoseconds>(executed - started).count() - _sliceWaitNs);
+
+		bool running = Present(!turbo && _scheduler.IsLate());
+		auto rendered = clock::now();
+		Metrics::Record(Metrics::Histogram::RenderNs, std::chrono::duration_cast<std::chrono::nanoseconds>(rendered - executed).count());
+
+		if (!turbo)
+		{
+			Timeline::Zone sleep("Sleep");
+			_scheduler.Wait();
+			Metrics::Record(Metrics::Histogram::SleepNs, ElapsedNs(rendered) + _sliceWaitNs);
+		}
 
 		return running;
 	}
 
+	void Chip8::SampleInput(uint slice, uint slices)
+	{
+		Timeline::Zone zone("PollInput");
+		auto time = clock::now();
+		if (!_config.Core.Turbo)
+		{
+			//behind schedule the slice time is in the past, keys pressed later wait for their slice
+			auto started = time;
+			time = _scheduler.GetSliceTime(slice, slices);
+			std::this_thread::sleep_until(time);
+			_sliceWaitNs += ElapsedNs(started);
+		}
+		_backend.PollInput(time);
+	}
+
+	bool Chip8::Present(bool late)
+	{
+		if (!_backend.ProcessEvents(_framebuffer))
+			return false;
+
+		//border follows the buzzer, keep rendering while it sounds and once after it stops
+		bool buzzing = _buzzer != 0;
+		if (_config.Core.Elide && !_framebuffer.IsDirty() && !buzzing && !_buzzerShown)
+		{
+			_scheduler.OnElided();
+			return true;
+		}
+		//framebuffer stays dirty, next presented frame catches up
+		if (late && _scheduler.Skip(_config.Core.FrameSkip))
+			return true;
+
+		Timeline::Zone zone("Render");
+		_framebuffer.ResetDirty();
+		_buzzerShown = buzzing;
+		_scheduler.OnRendered();
+		return _backend.Render(_framebuffer);
+	}
+
+	uint Chip8::Run(uint speed)
+	{
+		//recompiled blocks read the delay timer inline, spin loops are detected by the interpreter only
+		if (_static && _config.Core.Static && !_autoSpeed && !_profiler && !_tracer && !_coverage)
+			return StaticRun(speed);
+
+		uint n = 0;
+		while (n < speed && !_waitingInput && _running && !_idle)
+		{
+			Step();
+			++n;
+		}
+		return n;
+	}
+
+	uint Chip8::StaticRun(uint speed)
+	{
+		StaticContext context(*this);
+		uint n = 0;
+		while (n < speed && !_waitingInput && _running)
+		{
+			auto block = _staticBlocks[_pc];
+			if (block && n + block->Count <= speed && _static->IsIntact(_memory.GetData(), *block))
+				n += block->Run(context);
+			else
+			{
+				Step();
+				++n;
+			}
+		}
+		return n;
+	}
+
+	uint Chip8::DebugRun(uint speed)
+	{
+		uint n = 0;
+		while (n < speed && !_waitingInput && _running && !_idle)
+		{
+			_debugger->BeforeStep();
+			if (!_running)
+				break;
+			Step();
+			++n;
+			_debugger->AfterStep();
+		}
+		return n;
+	}
+
+	void Chip8::Scroll(int dx, int dy)
+	{
+		Metrics::Add(Metrics::Counter::Scrolls);
+		if (!_profiler)
+		{
+			_framebuffer.Scroll(dx, dy);
+			return;
+		}
+		auto started = clock::now();
+		_framebuffer.Scroll(dx, dy);
+		_profiler->OnScroll(ElapsedNs(started));
+	}
+
+	bool Chip8::IsDelayWaitLoop(u16 addr, u8 x) const
+	{
+		auto op = [this](u16 addr) { return Pack16(_memory.Get(addr), _memory.Get(addr + 1)); };
+		u16 skip = op(addr + 2), jump = op(addr + 4);
+		bool skipOnX = ((skip & 0xf000) == 0x3000 || (skip & 0xf000) == 0x4000) && (skip & 0x0fff) == (x << 8);
+		u16 target = jump & 0x0fff;
+		return skipOnX && (jump & 0xf000) == 0x1000 && target <= addr && addr - target <= 16;
+	}
+
 	bool Chip8::Sprite(u8 plane, u8 x, u8 y, u8 h, u16 i)
+	{
+		if (_coverage)
+			_coverage->Mark(Coverage::Sprite, i, h? h: 32);
+		bool collision;
+		if (_profiler)
+		{
+			auto started = clock::now();
+			collision = DrawSprite(plane, x, y, h, i);
+			_profiler->OnSprite(ElapsedNs(started));
+		}
+		else
+			collision = DrawSprite(plane, x, y, h, i);
+		Metrics::Add(Metrics::Counter::Sprites);
+		if (collision)
+			Metrics::Add(Metrics::Counter::Collisions);
+		return collision;
+	}
+
+	bool Chip8::DrawSprite(u8 plane, u8 x, u8 y, u8 h, u16 i)
 	{
 		bool collision = false;
 		if (h == 0) //16x16 mode
@@ -124,10 +338,33 @@ namespace chip8
 		return collision;
 	}
 
-	void Chip8::Step()
+	void Chip8::TracedStep()
+	{
+		TraceRecord record;
+		record.PC = _pc;
+		record.Op = Pack16(_memory.Get(_pc), _memory.Get(_pc + 1));
+		auto reg = _reg;
+
+		Execute();
+
+		record.I = _i;
+		record.Reg = TraceRecord::NoRegister;
+		record.Value = 0;
+		for(u8 r = 0; r < reg.size(); ++r)
+			if (reg[r] != _reg[r])
+			{
+				record.Reg = r;
+				record.Value = _reg[r];
+				break;
+			}
+		_tracer->Write(record);
+	}
+
+	void Chip8::Execute()
 	{
 		if (_pc < 0x200) {
-			fprintf(stderr, "executing protected ROM space, halting...\n");
+			if (!_haltOnFault)
+				fprintf(stderr, "executing protected ROM space, halting...\n");
 			Halt();
 			return;
 		}
@@ -136,6 +373,10 @@ namespace chip8
 		u8 group = hh >> 4;
 		u8 x = hh & 0x0f;
 		u16 op = Pack16(hh, nn); //remove it
+		if (_profiler)
+			_profiler->OnStep(_pc - 2, op);
+		if (_coverage)
+			_coverage->Mark(Coverage::Executed, _pc - 2, op == 0xf000? 4: 2);
 
 		switch(group)
 		{
@@ -146,45 +387,40 @@ namespace chip8
 				switch(nn)
 				{
 					case 0x00:
-						TRACEI("halt");
 						Halt();
 						break;
 					case 0xc0 ... 0xcf:
-						TRACEI("scroll-down %d", nn & 0x0f);
-						_framebuffer.Scroll(0, nn & 0x0f); //down n pixels
+						Scroll(0, nn & 0x0f); //down n pixels
 						break;
 					case 0xd0 ... 0xdf:
-						TRACEI("scroll-up %d", nn & 0x0f);
-						_framebuffer.Scroll(0, -(nn & 0x0f)); //down n pixels
+						Scroll(0, -(nn & 0x0f)); //down n pixels
 						break;
 					case 0xe0: //clear
-						TRACEI("clear");
 						_framebuffer.Clear();
 						break;
 					case 0xee: //ret
-						TRACEI("ret");
 						if (_sp == 0)
-							InvalidOp(op); //stack overflow, replace method
+						{
+							RaiseFault(Fault::StackUnderflow, op);
+							break;
+						}
 						_pc = _stack[--_sp];
+						if (_profiler)
+							_profiler->OnReturn();
 						break;
 					case 0xfb: //scroll right 4
-						TRACEI("scroll-right");
-						_framebuffer.Scroll(4, 0);
+						Scroll(4, 0);
 						break;
 					case 0xfc: //scroll left 4
-						TRACEI("scroll-left");
-						_framebuffer.Scroll(-4, 0);
+						Scroll(-4, 0);
 						break;
 					case 0xfd: //halt
-						TRACEI("exit");
 						Halt();
 						break;
 					case 0xfe: //lores
-						TRACEI("lores");
 						_framebuffer.SetResolution(64, 32);
 						break;
 					case 0xff: //hires
-						TRACEI("hires");
 						_framebuffer.SetResolution(128, 64);
 						break;
 					default:
@@ -198,26 +434,27 @@ namespace chip8
 			break;
 
 		case 0x1: //jump NNN
-			TRACEI("jump 0x%04x", Pack16(x, nn));
 			_pc = Pack16(x, nn);
 			break;
 
 		case 0x2: //call NNN
-			TRACEI("call 0x%04x", Pack16(x, nn));
 			if (_sp >= _stack.size())
-				throw std::runtime_error("stack overflow");
+			{
+				RaiseFault(Fault::StackOverflow, op);
+				break;
+			}
 			_stack[_sp++] = _pc;
 			_pc = Pack16(x, nn);
+			if (_profiler)
+				_profiler->OnCall(_pc);
 			break;
 
 		case 0x3: //SE VX, NN
-			TRACEI("skip-eq v%x 0x%02x", x, nn);
 			if (_reg[x] == nn)
 				SkipNext();
 			break;
 
 		case 0x4: //SNE VX, NN
-			TRACEI("skip-ne v%x 0x%02x", x, nn);
 			if (_reg[x] != nn)
 				SkipNext();
 			break;
@@ -229,24 +466,21 @@ namespace chip8
 				switch(z)
 				{
 				case 0: //SE VX, VY
-					TRACEI("skip-e v%x v%x", x, y);
 					if (_reg[x] == _reg[y])
 						SkipNext();
 					break;
 
 				case 2: //SAVE VX-VY range
-					TRACEI("save v%x-v%x", x, y);
 					SaveRange(x, y);
 					break;
 
 				case 3: //LOAD VX-VY range
-					TRACEI("load v%x-v%x", x, y);
 					LoadRange(x, y);
 					break;
 
 				case 0xf: //DUMP VX-VY range
-					TRACEI("dump v%x-v%x", x, y);
-					DumpRange(x, y);
+					if (!_haltOnFault)
+						DumpRange(x, y);
 					break;
 
 				default:
@@ -256,12 +490,10 @@ namespace chip8
 			break;
 
 		case 0x6: //LD VX, NN
-			TRACEI("v%x := 0x%02x", x, nn);
 			_reg[x] = nn;
 			break;
 
 		case 0x7:
-			TRACEI("v%x += 0x%02x", x, nn);
 			_reg[x] += nn;
 			break;
 
@@ -271,16 +503,15 @@ namespace chip8
 				u8 z = nn & 0x0f;
 				switch(z)
 				{
-				case 0x0: TRACE("v%x = v%x\n", x, y);  _reg[x]  = _reg[y]; break;
-				case 0x1: TRACE("v%x |= v%x\n", x, y); _reg[x] |= _reg[y]; break;
-				case 0x2: TRACE("v%x &= v%x\n", x, y); _reg[x] &= _reg[y]; break;
-				case 0x3: TRACE("v%x ^= v%x\n", x, y); _reg[x] ^= _reg[y]; break;
-				case 0x4: TRACE("v%x += v%x\n", x, y); { u16 r = _reg[x] + _reg[y]; WriteResult(x, r & 0xff, r > 0xff); } break;
-				case 0x5: TRACE("v%x -= v%x\n", x, y); { u8  r = _reg[x] - _reg[y]; WriteResult(x, r, _reg[x] >= _reg[y]); } break;
-				case 0x7: TRACE("v%x =- v%x\n", x, y); { u8  r = _reg[y] - _reg[x]; WriteResult(x, r, _reg[y] >= _reg[x]); } break;
+				case 0x0: _reg[x]  = _reg[y]; break;
+				case 0x1: _reg[x] |= _reg[y]; break;
+				case 0x2: _reg[x] &= _reg[y]; break;
+				case 0x3: _reg[x] ^= _reg[y]; break;
+				case 0x4: { u16 r = _reg[x] + _reg[y]; WriteResult(x, r & 0xff, r > 0xff); } break;
+				case 0x5: { u8  r = _reg[x] - _reg[y]; WriteResult(x, r, _reg[x] >= _reg[y]); } break;
+				case 0x7: { u8  r = _reg[y] - _reg[x]; WriteResult(x, r, _reg[y] >= _reg[x]); } break;
 				case 0x6:
 					{
-						TRACE("v%x >> v%x\n", x, y);
 						if (!_config.Quirks.Shift)
 						{ u8  r = _reg[y] >> 1; WriteResult(x, r, _reg[y] & 1); }
 						else
@@ -289,7 +520,6 @@ namespace chip8
 					break;
 				case 0xe:
 					{
-						TRACE("v%x << v%x\n", x, y);
 						if (!_config.Quirks.Shift)
 						{ u8  r = _reg[y] << 1; WriteResult(x, r, _reg[y] & 0x80); }
 						else
@@ -305,28 +535,22 @@ namespace chip8
 				u8 y = nn >> 4;
 				u8 z = nn & 0x0f;
 
-				TRACEI("skip-ne v%x v%x ; z = %u", x, y, z);
-
 				if (z != 0)
 					InvalidOp(op);
-
-				if (_reg[x] != _reg[y])
+				else if (_reg[x] != _reg[y])
 					SkipNext();
 			}
 			break;
 
 		case 0xa: //MOV I, NNN
 			_i = Pack16(x, nn);
-			TRACEI("i := 0x%04x", _i);
 			break;
 
 		case 0xb: //JUMP0 NNN
-			TRACEI("jump0 0x%04x", Pack16(x, nn));
 			_pc = Pack16(x, nn) + _reg[0];
 			break;
 
 		case 0xc:
-			TRACEI("random %u", nn);
 			_reg[x] = _randomDistribution(_randomGenerator) & nn;
 			break;
 
@@ -334,7 +558,6 @@ namespace chip8
 			{
 				u8 y = nn >> 4;
 				u8 z = nn & 0x0f;
-				TRACEI("sprite v%x v%x %u", x, y, z);
 				u8 xp = _reg[x];
 				u8 yp = _reg[y];
 				switch(_planes)
@@ -357,12 +580,10 @@ namespace chip8
 			switch(nn)
 			{
 			case 0x9e:
-				TRACEI("skip v%x key", x);
 				if (_backend.GetKeyState(_reg[x]))
 					SkipNext();
 				break;
 			case 0xa1:
-				TRACEI("skip v%x -key", x);
 				if (!_backend.GetKeyState(_reg[x]))
 					SkipNext();
 				break;
@@ -380,87 +601,78 @@ namespace chip8
 					u8 h = _memory.Get(_pc++);
 					u8 l = _memory.Get(_pc++);
 					_i = Pack16(h, l);
-					TRACEI("i := long 0x%04x", _i);
 				}
 				else
 					InvalidOp(op);
 				break;
 
 			case 0x01: //plane
-				TRACEI("plane %u", x);
 				_planes = x & 0x03;
 				break;
 
 			case 0x02: //audio
-				TRACEI("audio");
 				_audio.SetBaseAddr(_i);
+				if (_coverage)
+					_coverage->Mark(Coverage::Read, _i, 16);
 				break;
 
 			case 0x07: //vX = delay
 				_reg[x] = _delay;
-				TRACEI("v%x = delay ; %u\n", x, _delay);
 				_delayRead = true;
+				if (_autoSpeed)
+					_idle = _speedTuner.OnDelayRead(_pc - 2, _delay, [this, x]() { return IsDelayWaitLoop(_pc - 2, x); });
 				break;
 
 			case 0x0a: //vX = key
-				TRACEI("v%x := key", x);
 				_waitingInput = true;
 				_waitingInputFinished = false;
 				_inputReg = x;
 				break;
 
 			case 0x15: //delay vX
-				TRACEI("delay := v%x", x);
 				_delay = _reg[x];
 				break;
 
 			case 0x18: //buzzer vX
-				TRACEI("buzzer := v%x", x);
 				_buzzer = _reg[x];
 				_backend.SetAudio(_buzzer? &_audio: nullptr);
 				break;
 
 			case 0x1e: //i += vX
-				TRACEI("i += v%x", x);
 				_i += _reg[x];
 				break;
 
 			case 0x29: //hex
-				TRACEI("i = hex v%x", x);
 				_i = Memory::FontOffset + (_reg[x] & 0xf) * 5;
 				break;
 
 			case 0x30: //bighex
-				TRACEI("i = bighex v%x", x);
 				_i = Memory::BigFontOffset + (_reg[x] & 0xf) * 10;
 				break;
 
 			case 0x33: //bcd
 				{
-					TRACEI("bcd v%x", x);
 					_memory.Set(_i + 0, (_reg[x] / 100) % 10);
 					_memory.Set(_i + 1, (_reg[x] / 10) % 10);
 					_memory.Set(_i + 2, _reg[x] % 10);
+					if (_coverage)
+						_coverage->Mark(Coverage::Written, _i, 3);
 				}
 				break;
 
 			case 0x55: //save v0-vX
-				TRACEI("save v%x", x);
 				SaveRange(0, x); if (!_config.Quirks.LoadStore) _i += x + 1;
 				break;
 
 			case 0x65: //load v0-vX
-				TRACEI("load v%x", x);
 				LoadRange(0, x); if (!_config.Quirks.LoadStore) _i += x + 1;
 				break;
 
 			case 0x75: //export flags
-				TRACEI("saveflags v%x", x);
 				_config.SaveFlags(_reg.data(), x + 1);
 				break;
 
 			case 0x85: //import flags
-				TRACEI("loadflags v%x", x);
 				_config.LoadFlags(_reg.data(), x + 1);
 				break;
 
@@ -476,24 +688,125 @@ namespace chip8
 
 	void Chip8::Load(const u8 * data, size_t dataSize)
 	{
-		size_t n = std::min<size_t>(dataSize, 0x10000 - EntryPoint);
-		u8 *dst = _memory.GetData() + EntryPoint;
-		std::copy(data, data + n, dst);
+		_memory.Load(EntryPoint, data, dataSize);
+		_romHash = Hash(data, dataSize);
+
+		_static = StaticProgram::Find(data, dataSize);
+		_staticBlocks.clear();
+		if (_static)
+		{
+			_staticBlocks.resize(Memory::Size);
+			for(size_t i = 0; i < _static->BlockCount; ++i)
+				_staticBlocks[_static->Blocks[i].Begin] = &_static->Blocks[i];
+		}
 	}
 	void Chip8::Reset()
 	{
 		_memory.Reset();
+		_reg.fill(0);
+		_stack.fill(0);
 		_pc = EntryPoint;
+		_i = 0;
 		_sp = 0;
 		_planes = 1;
 		_delay = 0;
 		_buzzer = 0;
 		_running = true;
+		_fault = Fault::None;
+		_faultOp = 0;
+		_inputReg = 0;
+		_instructions = 0;
+		_speedTuner.Reset();
+		_idle = false;
 		_framebuffer.SetResolution(64, 32);
 		_backend.SetAudio(nullptr);
 		_waitingInput = false;
 	}
 
+	void Chip8::Seed(u32 seed)
+	{
+		_randomGenerator.seed(seed);
+		_randomDistribution.reset();
+		_audio.Seed(seed);
+	}
+
+	void Chip8::SaveState(std::vector<u8> &data) const
+	{
+		StateWriter writer(data);
+		writer.Write(StateMagic, sizeof(StateMagic));
+		writer.Write8(StateVersion);
+		writer.Write64(_romHash);
+
+		writer.Write16(_pc);
+		writer.Write16(_i);
+		writer.Write8(_sp);
+		writer.Write8(_planes);
+		writer.Write8(_delay);
+		writer.Write8(_buzzer);
+		writer.Write8((_running? 1: 0) | (_waitingInput? 2: 0) | (_waitingInputFinished? 4: 0) | (_delayRead? 8: 0));
+		writer.Write8(_inputReg);
+		writer.Write8(static_cast<u8>(_fault));
+		writer.Write16(_faultOp);
+		writer.Write64(_instructions);
+		writer.Write(_reg.data(), _reg.size());
+		for(auto addr : _stack)
+			writer.Write16(addr);
+		writer.Write(_config.Flags.data(), _config.Flags.size());
+
+		std::stringstream random;
+		random << _randomGenerator;
+		writer.WriteString(random.str());
+
+		_audio.SaveState(writer);
+		_framebuffer.SaveState(writer);
+		_memory.SaveState(writer);
+	}
+
+	void Chip8::LoadState(const u8 *data, size_t size)
+	{
+		StateReader reader(data, size);
+		char magic[sizeof(StateMagic)];
+		reader.Read(magic, sizeof(magic));
+		if (memcmp(magic, StateMagic, sizeof(magic)) != 0 || reader.Read8() != StateVersion)
+			throw std::runtime_error("invalid state");
+		if (reader.Read64() != _romHash)
+			throw std::runtime_error("state was saved with different rom");
+
+		_pc = reader.Read16();
+		_i = reader.Read16();
+		_sp = reader.Read8();
+		_planes = reader.Read8() & 0x03;
+		_delay = reader.Read8();
+		_buzzer = reader.Read8();
+		u8 flags = reader.Read8();
+		_running = flags & 1;
+		_waitingInput = flags & 2;
+		_waitingInputFinished = flags & 4;
+		_delayRead = flags & 8;
+		_inputReg = reader.Read8() & 0x0f;
+		_fault = static_cast<Fault>(reader.Read8());
+		_faultOp = reader.Read16();
+		_instructions = reader.Read64();
+		reader.Read(_reg.data(), _reg.size());
+		for(auto &addr : _stack)
+			addr = reader.Read16();
+		reader.Read(_config.Flags.data(), _config.Flags.size());
+		if (_sp > _stack.size())
+			throw std::runtime_error("invalid stack pointer in state");
+
+		std::stringstream random(reader.ReadString());
+		random >> _randomGenerator;
+		_randomDistribution.reset();
+
+		_audio.LoadState(reader);
+		_framebuffer.LoadState(reader);
+		_memory.LoadState(reader);
+		if (!reader.AtEnd())
+			throw std::runtime_error("trailing data in state");
+
+		_backend.SetAudio(_buzzer? &_audio: nullptr);
+	}
+
 	void Chip8::Dump()
 	{
 		fprintf(stderr, "CHIP8 halted at address pc: 0x%04x, i: 0x%04x, delay: %u, buzzer: %u\n", (uint)_pc, (uint)_i, (uint)_delay, (uint)_buzzer);
@@ -2,21 +2,43 @@
 #define CHIP8_H
 
 #include <chip8/Audio.h>
+#include <chip8/Coverage.h>
 #include <chip8/Framebuffer.h>
+#include <chip8/FrameScheduler.h>
 #include <chip8/Memory.h>
+#include <chip8/SpeedTuner.h>
 #include <chip8/types.h>
 #include <array>
 #include <random>
+#include <vector>
 
 namespace chip8
 {
 	class Backend;
+	class Debugger;
+	class Profiler;
+	struct StaticBlock;
+	struct StaticProgram;
+	class Tracer;
 	struct Config;
 
+	enum class Fault : u8
+	{
+		None,
+		InvalidInstruction,
+		StackOverflow,
+		StackUnderflow
+	};
+
 	class Chip8
 	{
+		friend class Debugger;
+		friend struct StaticContext;
+
 		static constexpr uint EntryPoint			= 0x200;
 		static constexpr u8 VF						= 0x0f;
+		static constexpr char StateMagic[4]			= { 'X', 'O', 'S', 'T' };
+		static constexpr u8 StateVersion			= 1;
 
 	private:
 		Config &			_config;
@@ -24,6 +46,13 @@ namespace chip8
 		Memory				_memory;
 		Framebuffer			_framebuffer;
 		Audio				_audio;
+		Profiler *			_profiler;
+		Tracer *			_tracer;
+		Debugger *			_debugger;
+		Coverage *			_coverage;
+
+		const StaticProgram *				_static;
+		std::vector<const StaticBlock *>	_staticBlocks;
 
 		std::array<u8, 16>	_reg;
 		std::array<u16, 16>	_stack;
@@ -37,6 +66,19 @@ namespace chip8
 		bool				_waitingInputFinished;
 		u8					_inputReg;
 		bool				_delayRead;
+		bool				_haltOnFault;
+		Fault				_fault;
+		u16					_faultOp;
+		u64					_instructions;
+		u64					_romHash;
+
+		SpeedTuner			_speedTuner;
+		bool				_autoSpeed;	//Core.AutoSpeed latched per frame
+		bool				_idle;		//spin loop detected, rest of frame is skipped
+
+		FrameScheduler		_scheduler;
+		bool				_buzzerShown;	//last presented frame had buzzer border
+		u64					_sliceWaitNs;	//time slept between slices of current frame
 
 		std::default_random_engine _randomGenerator;
 		std::uniform_int_distribution<u8> _randomDistribution;
@@ -55,6 +97,8 @@ namespace chip8
 
 		void SaveRange(u8 x, u8 y)
 		{
+			if (_coverage)
+				_coverage->Mark(Coverage::Written, _i, (x < y? y - x: x - y) + 1);
 			if (x < y)
 				for(u8 i = 0; i <= y - x; ++i) _memory.Set(_i + i, _reg[x + i]);
 			else
@@ -63,6 +107,8 @@ namespace chip8
 
 		void LoadRange(u8 x, u8 y)
 		{
+			if (_coverage)
+				_coverage->Mark(Coverage::Read, _i, (x < y? y - x: x - y) + 1);
 			if (x < y)
 				for(u8 i = 0; i <= y - x; ++i) _reg[x + i] = _memory.Get(_i + i);
 			else
@@ -79,7 +125,19 @@ namespace chip8
 			printf("\n");
 		}
 
+		///FX07 at addr followed by skip on vX and jump back to it
+		bool IsDelayWaitLoop(u16 addr, u8 x) const;
+
+		///runs frame budget in slices, Tick spreads them over the frame and polls input in between
+		bool AdvanceFrame(uint slices);
+		///waits for start of slice unless Core.Turbo is set and lets backend apply key changes made until then
+		void SampleInput(uint slice, uint slices);
+		///processes backend events every frame, renders only frames with changes unless late and allowed to skip
+		bool Present(bool late);
+
 		bool Sprite(u8 plane, u8 x, u8 y, u8 h, u16 i);
+		bool DrawSprite(u8 plane, u8 x, u8 y, u8 h, u16 i);
+		void Scroll(int dx, int dy);
 
 	public:
 		static constexpr uint TimerFreq = 60;
@@ -87,18 +145,90 @@ namespace chip8
 
 		Chip8(Config & config, Backend & backend);
 
+		///back to power-on state with loaded rom, memory cost is proportional to pages written since last reset
 		void Reset();
-
+		void Seed(u32 seed);
+		void SetProfiler(Profiler * profiler)
+		{ _profiler = profiler; }
+		void SetTracer(Tracer * tracer)
+		{ _tracer = tracer; }
+		void SetDebugger(Debugger * debugger)
+		{ _debugger = debugger; }
+		void SetCoverage(Coverage * coverage)
+		{ _coverage = coverage; }
+
+		///faults stop the machine instead of throwing and diagnostics are not printed, for fuzzing and batch runs
+		void SetHaltOnFault(bool halt)
+		{ _haltOnFault = halt; }
+
+		///one 60Hz frame: input wait, Core.Speed instructions and timers, no rendering or sleeping
+		///returns false once machine has halted
+		bool AdvanceFrame()
+		{ return AdvanceFrame(1); }
+		///AdvanceFrame, render and sleep until the end of frame unless Core.Turbo is set
+		///frames are scheduled on a fixed grid, late frames may be skipped as set by Core.FrameSkip
 		bool Tick();
+		///processes backend events and passes framebuffer to backend if changed, returns false if backend wants to quit
+		bool Render()
+		{ return Present(false); }
+		///executes up to n instructions without rendering, sleeping or ticking timers, returns number executed
+		uint RunCycles(uint n)
+		{
+			uint executed = Run(n);
+			_instructions += executed;
+			return executed;
+		}
+
 		void Load(const u8 * data, size_t dataSize);
-		void Halt()
-		{ _running = false; Dump(); }
+		void Halt();
 
-		[[ noreturn ]] void InvalidOp(u16 op);
+		bool IsRunning() const
+		{ return _running; }
+
+		Fault GetFault() const
+		{ return _fault; }
+
+		u16 GetFaultOp() const
+		{ return _faultOp; }
+
+		///internal consistency check for fuzzing, false means interpreter bug
+		bool CheckInvariants() const;
+
+		///appends snapshot of complete machine state, memory is stored as pages changed from loaded rom
+		void SaveState(std::vector<u8> &data) const;
+		///restores snapshot taken with the same rom loaded, throws on mismatch or corrupted data
+		void LoadState(const u8 *data, size_t size);
+
+		const Framebuffer & GetFramebuffer() const
+		{ return _framebuffer; }
+
+		const SpeedTuner & GetSpeedTuner() const
+		{ return _speedTuner; }
+
+		const FrameScheduler::Stats & GetFrameStats() const
+		{ return _scheduler.GetStats(); }
+
+		u64 GetInstructionCount() const
+		{ return _instructions; }
+
+		void RaiseFault(Fault fault, u16 op);
+		void InvalidOp(u16 op)
+		{ RaiseFault(Fault::InvalidInstruction, op); }
 		void Dump();
 
 	private:
-		void Step();
+		void Step()
+		{
+			if (_tracer)
+				TracedStep();
+			else
+				Execute();
+		}
+		void TracedStep();
+		void Execute();
+		uint Run(uint n);
+		uint DebugRun(uint n);
+		uint StaticRun(uint n);
 	};
 }
 
@@ -1,5 +1,8 @@
 #include <chip8/Config.h>
 #include <chip8/File.h>
+#include <chip8/FlagStore.h>
+#include <chip8/MappedFile.h>
+#include <charconv>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -8,112 +11,262 @@ namespace chip8
 {
 	namespace
 	{
+		std::string Quote(std::string_view value)
+		{ return "'" + std::string(value) + "'"; }
 
-		int ParseInt(const std::string &value)
-		{ return atoi(value.c_str()); }
+		uint ParseInt(std::string_view value)
+		{
+			uint result;
+			auto r = std::from_chars(value.data(), value.data() + value.size(), result);
+			if (r.ec != std::errc() || r.ptr != value.data() + value.size())
+				throw std::runtime_error("invalid integer value " + Quote(value));
+			return result;
+		}
 
-		bool ParseBoolean(const std::string &value)
+		bool ParseBoolean(std::string_view value)
 		{
 			if (value == "on" || value == "1" || value == "true")
 				return true;
 			if (value == "off" || value == "0" || value == "false")
-				return true;
-			throw std::runtime_error("invalid boolean value " + value);
+				return false;
+			throw std::runtime_error("invalid boolean value " + Quote(value));
+		}
+
+		u8 ParseHexDigit(char c, std::string_view value)
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+			if (c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+			if (c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			throw std::runtime_error("invalid hex digit in color value " + Quote(value));
 		}
 
-		Config::Color ParseColor(const std::string &value)
+		Config::Color ParseColor(std::string_view value)
 		{
 			if (value.empty() || value[0] != '#')
-				throw std::runtime_error("invalid prefix for color value " + value);
-			uint r, g, b;
+				throw std::runtime_error("invalid prefix for color value " + Quote(value));
+			auto digit = [value](size_t i) { return ParseHexDigit(value[i], value); };
 			switch(value.size())
 			{
 			case 7:
-				if (sscanf(value.c_str(), "#%02x%02x%02x", &r, &g, &b) != 3)
-					throw std::runtime_error("invalid 7-color value " + value);
-				return Config::Color { (u8)r, (u8)g, (u8)b };
+				return Config::Color { u8(digit(1) << 4 | digit(2)), u8(digit(3) << 4 | digit(4)), u8(digit(5) << 4 | digit(6)) };
 			case 4:
-				if (sscanf(value.c_str(), "#%1x%1x%1x", &r, &g, &b) != 3)
-					throw std::runtime_error("invalid 3-color value " + value);
-				r = (r << 4) | r;
-				g = (g << 4) | g;
-				b = (b << 4) | b;
-				return Config::Color { (u8)r, (u8)g, (u8)b };
+				return Config::Color { u8(digit(1) * 0x11), u8(digit(2) * 0x11), u8(digit(3) * 0x11) };
 			default:
-				throw std::runtime_error("invalid color value " + value);
+				throw std::runtime_error("invalid color value " + Quote(value));
 			}
 		}
 
+		[[noreturn]] void UnknownParameter(const char *section, std::string_view name)
+		{ throw std::runtime_error(std::string("unknown parameter ") + section + "." + std::string(name)); }
 	}
-	void Config::CoreConfig::Set(const std::string& name, const std::string& value)
+
+	//keys are dispatched on length first, leaving at most one or two comparisons per key
+
+	void Config::CoreConfig::Set(std::string_view name, std::string_view value)
 	{
-		if (name == "speed")
-			Speed = ParseInt(value);
-		else if (name == "delayloop")
-			DelayLoop = ParseInt(value);
-		else
-			throw std::runtime_error("unknown parameter core." + name);
+		switch(name.size())
+		{
+		case 5:
+			if (name == "speed")		{ Speed = ParseInt(value); return; }
+			if (name == "turbo")		{ Turbo = ParseBoolean(value); return; }
+			if (name == "elide")		{ Elide = ParseBoolean(value); return; }
+			break;
+		case 6:
+			if (name == "static")		{ Static = ParseBoolean(value); return; }
+			if (name == "slices")		{ Slices = ParseInt(value); return; }
+			break;
+		case 9:
+			if (name == "delayloop")	{ DelayLoop = ParseInt(value); return; }
+			if (name == "autospeed")	{ AutoSpeed = ParseBoolean(value); return; }
+			if (name == "frameskip")	{ FrameSkip = ParseInt(value); return; }
+			break;
+		}
+		UnknownParameter("core", name);
 	}
 
-	void Config::PaletteConfig::Set(const std::string& name, const std::string& value)
+	void Config::PaletteConfig::Set(std::string_view name, std::string_view value)
 	{
-		if (name == "bg")
-			BG = ParseColor(value);
-		else if (name == "color1")
-			C1 = ParseColor(value);
-		else if (name == "color2")
-			C2 = ParseColor(value);
-		else if (name == "blend")
-			BL = ParseColor(value);
-		else if (name == "buzzer")
-			Buzz = ParseColor(value);
-		else if (name == "border")
-			Border = ParseColor(value);
-		else
-			throw std::runtime_error("unknown parameter palette." + name);
+		switch(name.size())
+		{
+		case 2:
+			if (name == "bg")			{ BG = ParseColor(value); return; }
+			break;
+		case 5:
+			if (name == "blend")		{ BL = ParseColor(value); return; }
+			break;
+		case 6:
+			if (name == "color1")		{ C1 = ParseColor(value); return; }
+			if (name == "color2")		{ C2 = ParseColor(value); return; }
+			if (name == "buzzer")		{ Buzz = ParseColor(value); return; }
+			if (name == "border")		{ Border = ParseColor(value); return; }
+			break;
+		}
+		UnknownParameter("palette", name);
 	}
 
-	void Config::QuirksConfig::Set(const std::string& name, const std::string& value)
+	void Config::QuirksConfig::Set(std::string_view name, std::string_view value)
 	{
-		if (name == "shift")
-			Shift = ParseBoolean(value);
-		else if (name == "loadstore")
-			LoadStore = ParseBoolean(value);
-		else if (name == "vforder")
-			VFOrder = ParseBoolean(value);
-		else if (name == "clip")
-			Clip = ParseBoolean(value);
-		else if (name == "jump")
-			Jump = ParseBoolean(value);
-		else
-			throw std::runtime_error("unknown parameter quirks." + name);
+		switch(name.size())
+		{
+		case 4:
+			if (name == "clip")			{ Clip = ParseBoolean(value); return; }
+			if (name == "jump")			{ Jump = ParseBoolean(value); return; }
+			break;
+		case 5:
+			if (name == "shift")		{ Shift = ParseBoolean(value); return; }
+			break;
+		case 7:
+			if (name == "vforder")		{ VFOrder = ParseBoolean(value); return; }
+			break;
+		case 9:
+			if (name == "loadstore")	{ LoadStore = ParseBoolean(value); return; }
+			break;
+		}
+		UnknownParameter("quirks", name);
 	}
 
 
-	void Config::OnValue(const std::string &section, const std::string &name, const std::string &value)
+	void Config::OnValue(std::string_view section, std::string_view name, std::string_view value)
+	{
+		switch(section.size())
+		{
+		case 4:
+			if (section == "core")		return Core.Set(name, value);
+			break;
+		case 6:
+			if (section == "quirks")	return Quirks.Set(name, value);
+			break;
+		case 7:
+			if (section == "palette")	return Palette.Set(name, value);
+			break;
+		}
+		throw std::runtime_error("unknown section " + Quote(section));
+	}
+
+	void Config::LoadRomConfig(const std::string &romFile)
 	{
-		if (section == "core")
-			Core.Set(name, value);
-		else if (section == "quirks")
-			Quirks.Set(name, value);
-		else if (section == "palette")
-			Palette.Set(name, value);
+		auto dotPos = romFile.rfind('.');
+
+		std::string prefix;
+		if (dotPos != romFile.npos)
+			prefix = romFile.substr(0, dotPos);
 		else
-			throw std::runtime_error("unknown section " + section);
+			prefix = romFile;
+		{
+			auto slash = prefix.rfind('/');
+			if (slash == prefix.npos)
+				slash = 0;
+			else
+				++slash;
+			RomName = prefix.substr(slash);
+		}
+
+		std::string configFile = prefix + ".ini";
+		_romConfigFile = configFile;
+		if (File::Exists(configFile))
+		{
+			MappedFile cfg(configFile);
+			try
+			{ Parse(std::string_view(reinterpret_cast<const char *>(cfg.GetData()), cfg.GetSize())); }
+			catch(const std::runtime_error &ex)
+			{ throw std::runtime_error(configFile + ", " + ex.what()); }
+		}
 	}
 
-	std::string Config::GetConfigPath()
+	void Config::SaveRomValue(std::string_view section, std::string_view name, std::string_view value)
 	{
-		const char *home = getenv("HOME");
-		if (home == NULL)
-			home = ".";
-		std::string local = std::string(home) + "/.local";
-		mkdir(local.c_str(), 0770);
-		std::string share = local + "/share";
-		mkdir(share.c_str(), 0770);
-		std::string xomod = share + "/xomod";
-		mkdir(xomod.c_str(), 0770);
-		return xomod;
+		if (_romConfigFile.empty())
+			throw std::runtime_error("no rom config loaded");
+
+		std::string text;
+		if (File::Exists(_romConfigFile))
+			text = File(_romConfigFile, "rb").ReadAll<std::string>();
+
+		auto trim = [](std::string_view str)
+		{
+			auto begin = str.find_first_not_of(" \t\r\n");
+			auto end = str.find_last_not_of(" \t\r\n");
+			return begin == str.npos? std::string_view(): str.substr(begin, end - begin + 1);
+		};
+
+		//find line with the value or end of its section, same rules as parser
+		std::string line = std::string(name) + " = " + std::string(value) + "\n";
+		size_t insertAt = std::string::npos, replaceEnd = 0;
+		bool inSection = false;
+		for(size_t pos = 0; pos < text.size(); )
+		{
+			auto end = text.find('\n', pos);
+			end = end == text.npos? text.size(): end + 1;
+			auto current = trim(std::string_view(text).substr(pos, end - pos));
+			if (!current.empty() && current[0] == '[')
+			{
+				if (inSection)
+					break;
+				auto close = current.find(']');
+				inSection = close != current.npos && trim(current.substr(1, close - 1)) == section;
+				if (inSection)
+					insertAt = end;
+			}
+			else if (inSection && !current.empty() && current[0] != ';' && current[0] != '#')
+			{
+				auto eq = current.find('=');
+				if (eq != current.npos && trim(current.substr(0, eq)) == name)
+				{
+					insertAt = pos;
+					replaceEnd = end;
+					break;
+				}
+				insertAt = end;
+			}
+			pos = end;
+		}
+
+		if (insertAt == std::string::npos)
+		{
+			if (!text.empty() && text.back() != '\n')
+				text += '\n';
+			text += (text.empty()? "[": "\n[") + std::string(section) + "]\n" + line;
+		}
+		else
+		{
+			if (insertAt > 0 && text[insertAt - 1] != '\n')
+				text.insert(insertAt++, 1, '\n');
+			text.replace(insertAt, replaceEnd > insertAt? replaceEnd - insertAt: 0, line);
+		}
+
+		auto temp = _romConfigFile + ".tmp";
+		{
+			File file(temp, "wb");
+			file.Write(text.data(), text.size());
+		}
+		if (rename(temp.c_str(), _romConfigFile.c_str()) != 0)
+			throw std::runtime_error("could not replace " + _romConfigFile);
+	}
+
+	Config::Config(): Flags(), PersistFlags(true), _flagsLoaded(false)
+	{ }
+
+	Config::~Config() = default;
+
+	const std::string &Config::GetConfigPath()
+	{
+		static const std::string path = []()
+		{
+			const char *home = getenv("HOME");
+			if (home == NULL)
+				home = ".";
+			std::string local = std::string(home) + "/.local";
+			mkdir(local.c_str(), 0770);
+			std::string share = local + "/share";
+			mkdir(share.c_str(), 0770);
+			std::string xomod = share + "/xomod";
+			mkdir(xomod.c_str(), 0770);
+			return xomod;
+		}();
+		return path;
 	}
 
 	void Config::SaveFlags(const u8 * data, u8 n)
@@ -122,9 +275,13 @@ namespace chip8
 			n = Flags.size();
 
 		memcpy(Flags.data(), data, n);
-		auto configDir = GetConfigPath();
-		File file(configDir + "/" + RomName + ".flags", "wb");
-		file.Write(Flags.data(), Flags.size());
+		_flagsLoaded = true;
+		if (!PersistFlags)
+			return;
+
+		if (!_flagStore)
+			_flagStore.reset(new FlagStore());
+		_flagStore->Write(GetFlagsPath(), Flags.data(), Flags.size());
 	}
 
 	void Config::LoadFlags(u8 *data, u8 n)
@@ -132,14 +289,16 @@ namespace chip8
 		if (n > Flags.size())
 			n = Flags.size();
 
-		auto configDir = GetConfigPath();
-		auto flagsFile = configDir + "/" + RomName + ".flags";
-
-		if (File::Exists(flagsFile))
+		if (PersistFlags && !_flagsLoaded)
 		{
-			File file(flagsFile, "rb");
-			file.Read(Flags.data(), Flags.size());
+			auto flagsFile = GetFlagsPath();
+			if (File::Exists(flagsFile))
+			{
+				File file(flagsFile, "rb");
+				file.Read(Flags.data(), Flags.size());
+			}
 		}
+		_flagsLoaded = true;
 		memcpy(data, Flags.data(), n);
 	}
 
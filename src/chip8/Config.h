@@ -4,9 +4,12 @@
 #include <chip8/IniFileParser.h>
 #include <chip8/types.h>
 #include <array>
+#include <memory>
 
 namespace chip8
 {
+	class FlagStore;
+
 	struct Config : public IniFileParser<Config>
 	{
 		std::string RomName;
@@ -15,11 +18,17 @@ namespace chip8
 		{
 			uint Speed;
 			uint DelayLoop;
-
-			CoreConfig(): Speed(1000), DelayLoop(0)
+			bool Turbo;
+			bool Static; //use code from xomod-recompile if linked in
+			bool AutoSpeed; //Speed is only the starting point, see SpeedTuner
+			bool Elide; //do not render frames without framebuffer or buzzer changes
+			uint FrameSkip; //most frames in a row not presented when running behind schedule, see FrameScheduler
+			uint Slices; //Tick splits Speed into this many parts spread over the frame, sampling input before each
+
+			CoreConfig(): Speed(1000), DelayLoop(0), Turbo(false), Static(true), AutoSpeed(false), Elide(true), FrameSkip(2), Slices(4)
 			{ }
 
-			void Set(const std::string &name, const std::string &value);
+			void Set(std::string_view name, std::string_view value);
 		}
 		Core;
 
@@ -33,7 +42,7 @@ namespace chip8
 
 			QuirksConfig(): Shift(), LoadStore(), VFOrder(), Clip(), Jump() { }
 
-			void Set(const std::string &name, const std::string &value);
+			void Set(std::string_view name, std::string_view value);
 		}
 		Quirks;
 
@@ -56,21 +65,45 @@ namespace chip8
 				Border(BG)
 			{ }
 
-			void Set(const std::string &name, const std::string &value);
+			void Set(std::string_view name, std::string_view value);
 		}
 		Palette;
 
 		std::array<u8, 8> Flags;
+		bool PersistFlags; //off in deterministic runs, flags live in memory only
+
+		Config();
+		~Config();
 
-		Config(): Flags() { }
+		///sets RomName and parses sibling <rom>.ini if present
+		void LoadRomConfig(const std::string &romFile);
 
+		///sets section.name in sibling <rom>.ini, keeping other lines, creates file if needed
+		void SaveRomValue(std::string_view section, std::string_view name, std::string_view value);
+
+		///flags are read from disk once, saves update memory and are written out by background thread
 		void SaveFlags(const u8 *data, u8 n);
 		void LoadFlags(u8 *data, u8 n);
+		///forgets flags held in memory, next LoadFlags starts from disk or zeroes again
+		void ResetFlags()
+		{
+			Flags.fill(0);
+			_flagsLoaded = false;
+		}
+
+		///~/.local/share/xomod, created on first call
+		static const std::string &GetConfigPath();
 
 	private:
-		std::string GetConfigPath();
+		std::string					_romConfigFile;
+		std::unique_ptr<FlagStore>	_flagStore;
+		bool						_flagsLoaded;
+
+		std::string GetFlagsPath() const
+		{ return GetConfigPath() + "/" + RomName + ".flags"; }
+
 		friend class IniFileParser<Config>;
-		void OnValue(const std::string &section, const std::string &name, const std::string &value);
+		void OnValue(std::string_view section, std::string_view name, std::string_view value);
 
 	};
 }
@@ -0,0 +1,57 @@
+#include <chip8/Coverage.h>
+#include <chip8/File.h>
+#include <chip8/String.h>
+#include <sstream>
+#include <vector>
+
+namespace chip8
+{
+	namespace
+	{
+		const char * KindNames[Coverage::Kinds] = { "executed", "read", "written", "sprite" };
+	}
+
+	void Coverage::Save(const std::string &prefix) const
+	{
+		{
+			//red: written, green: executed, blue: read, sprites are shown in cyan
+			static constexpr uint Width = 256, Height = Memory::Size / Width;
+			std::string header = "P6\n" + std::to_string(Width) + " " + std::to_string(Height) + "\n255\n";
+			std::vector<u8> pixels(Memory::Size * 3);
+			for(uint addr = 0; addr < Memory::Size; ++addr)
+			{
+				u8 *rgb = pixels.data() + addr * 3;
+				rgb[0] = Get(Written, addr)? 0xff: 0;
+				rgb[1] = Get(Executed, addr)? 0xff: Get(Sprite, addr)? 0x80: 0;
+				rgb[2] = Get(Read, addr)? 0xff: Get(Sprite, addr)? 0xc0: 0;
+			}
+			File file(prefix + ".ppm", "wb");
+			file.Write(header.data(), header.size());
+			file.Write(pixels.data(), pixels.size());
+		}
+
+		std::stringstream ss;
+		for(uint kind = 0; kind < Kinds; ++kind)
+		{
+			uint total = 0;
+			std::stringstream ranges;
+			for(uint addr = 0; addr < Memory::Size; )
+			{
+				if (!Get(static_cast<Kind>(kind), addr))
+				{
+					++addr;
+					continue;
+				}
+				uint begin = addr;
+				while(addr < Memory::Size && Get(static_cast<Kind>(kind), addr))
+					++addr;
+				total += addr - begin;
+				ranges << KindNames[kind] << " 0x" << ToHex<u16>(begin) << " 0x" << ToHex<u16>(addr - 1) << "\n";
+			}
+			ss << "# " << KindNames[kind] << " " << total << " bytes\n" << ranges.str();
+		}
+		auto text = ss.str();
+		File file(prefix + ".cov", "wt");
+		file.Write(text.data(), text.size());
+	}
+}
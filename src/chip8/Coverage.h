@@ -0,0 +1,41 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <chip8/Memory.h>
+#include <chip8/types.h>
+#include <array>
+#include <string>
+
+namespace chip8
+{
+	///one bit per guest address for executed code, data reads/writes and sprite sources
+	class Coverage
+	{
+	public:
+		enum Kind { Executed, Read, Written, Sprite, Kinds };
+
+	private:
+		using Bitmap = std::array<u64, Memory::Size / 64>;
+		std::array<Bitmap, Kinds> _bitmaps;
+
+	public:
+		Coverage(): _bitmaps() { }
+
+		void Mark(Kind kind, u16 addr)
+		{ _bitmaps[kind][addr >> 6] |= 1ull << (addr & 63); }
+
+		void Mark(Kind kind, u16 addr, uint n)
+		{
+			while(n--)
+				Mark(kind, addr++);
+		}
+
+		bool Get(Kind kind, u16 addr) const
+		{ return _bitmaps[kind][addr >> 6] & (1ull << (addr & 63)); }
+
+		///writes <prefix>.ppm heatmap, one pixel per address, and <prefix>.cov address ranges
+		void Save(const std::string &prefix) const;
+	};
+}
+
+#endif
@@ -0,0 +1,377 @@
+#include <chip8/Debugger.h>
+#include <chip8/Chip8.h>
+#include <chip8/Disassembler.h>
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace chip8
+{
+	namespace
+	{
+		std::atomic<bool> interrupted(false);
+
+		void OnInterrupt(int)
+		{
+			//second ctrl-c before the emulator got to the first one quits as usual
+			if (interrupted.exchange(true))
+			{
+				signal(SIGINT, SIG_DFL);
+				raise(SIGINT);
+			}
+		}
+
+		bool ParseNumber(const std::string &text, u16 &value)
+		{
+			if (text.empty())
+				return false;
+			char *end;
+			unsigned long n = strtoul(text.c_str(), &end, 0);
+			if (*end || n > 0xffff)
+				return false;
+			value = n;
+			return true;
+		}
+
+		bool ParseRegister(const std::string &text, u8 &reg)
+		{
+			if (text.size() != 2 || (text[0] != 'v' && text[0] != 'V'))
+				return false;
+			char *end;
+			reg = strtoul(text.c_str() + 1, &end, 16);
+			return *end == 0;
+		}
+	}
+
+	bool Debugger::Condition::Check(const Chip8 & chip) const
+	{
+		u16 lhs;
+		switch(Lhs)
+		{
+		case Register:	lhs = chip._reg[Reg]; break;
+		case Index:		lhs = chip._i; break;
+		default:		return true;
+		}
+		switch(Op)
+		{
+		case EQ: return lhs == Value;
+		case NE: return lhs != Value;
+		case LT: return lhs < Value;
+		case GT: return lhs > Value;
+		case LE: return lhs <= Value;
+		case GE: return lhs >= Value;
+		}
+		return true;
+	}
+
+	std::string Debugger::Condition::ToString() const
+	{
+		if (Lhs == Always)
+			return std::string();
+
+		static const char *ops[] = { "==", "!=", "<", ">", "<=", ">=" };
+		char buffer[32];
+		if (Lhs == Register)
+			snprintf(buffer, sizeof(buffer), " if v%x %s 0x%02x", Reg, ops[Op], Value);
+		else
+			snprintf(buffer, sizeof(buffer), " if i %s 0x%04x", ops[Op], Value);
+		return buffer;
+	}
+
+	Debugger::Debugger(Chip8 & chip):
+		_chip(chip),
+		_breakpoints(Memory::Size), _watchedAddrs(Memory::Size), _watchedRegs(), _watchedIndex(false), _watches(0),
+		_paused(false), _stepsLeft(0), _memoryHit(-1), _reg(), _i(0)
+	{ _chip._memory.SetWatcher(this); }
+
+	Debugger::~Debugger()
+	{
+		for(uint page = 0; page < Memory::Pages; ++page)
+			_chip._memory.WatchPage(page, false);
+		_chip._memory.SetWatcher(nullptr);
+	}
+
+	void Debugger::CatchInterrupt()
+	{
+		struct sigaction action = {};
+		action.sa_handler = &OnInterrupt;
+		action.sa_flags = SA_RESTART;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGINT, &action, nullptr);
+	}
+
+	void Debugger::CheckInterrupt()
+	{
+		if (interrupted.load(std::memory_order_relaxed) && interrupted.exchange(false))
+			_paused = true;
+	}
+
+	void Debugger::BeforeStep()
+	{
+		u16 pc = _chip._pc;
+		if (_paused)
+		{
+			_paused = false;
+			Prompt("paused");
+		}
+		else if (_stepsLeft)
+		{
+			if (--_stepsLeft == 0)
+				Prompt("step");
+		}
+		else if (_breakpoints[pc])
+		{
+			auto it = _conditions.find(pc);
+			if (it != _conditions.end() && it->second.Check(_chip))
+				Prompt("breakpoint" + it->second.ToString());
+		}
+
+		_reg = _chip._reg;
+		_i = _chip._i;
+	}
+
+	void Debugger::AfterStep()
+	{
+		if (_memoryHit >= 0)
+		{
+			char buffer[64];
+			snprintf(buffer, sizeof(buffer), "watchpoint [0x%04x] = 0x%02x", _memoryHit, _chip._memory.Get(_memoryHit));
+			_memoryHit = -1;
+			Prompt(buffer);
+			return;
+		}
+		for(u8 r = 0; r < _reg.size(); ++r)
+		{
+			if (_watchedRegs[r] && _reg[r] != _chip._reg[r])
+			{
+				char buffer[64];
+				snprintf(buffer, sizeof(buffer), "watchpoint v%x: 0x%02x -> 0x%02x", r, _reg[r], _chip._reg[r]);
+				Prompt(buffer);
+				return;
+			}
+		}
+		if (_watchedIndex && _i != _chip._i)
+		{
+			char buffer[64];
+			snprintf(buffer, sizeof(buffer), "watchpoint i: 0x%04x -> 0x%04x", _i, _chip._i);
+			Prompt(buffer);
+		}
+	}
+
+	void Debugger::OnWrite(u16 index, u8 value)
+	{
+		if (_watchedAddrs[index] && _memoryHit < 0)
+			_memoryHit = index;
+	}
+
+	void Debugger::Prompt(const std::string &reason)
+	{
+		_stepsLeft = 0;
+		printf("%s at 0x%04x: %s\n", reason.c_str(), _chip._pc, Disassemble(_chip._memory.Get(_chip._pc) << 8 | _chip._memory.Get(_chip._pc + 1),
+			_chip._memory.Get(_chip._pc + 2) << 8 | _chip._memory.Get(_chip._pc + 3)).c_str());
+
+		std::string line;
+		while(true)
+		{
+			printf("(xomod) ");
+			fflush(stdout);
+			if (!std::getline(std::cin, line) || !Execute(line))
+				break;
+		}
+		interrupted = false; //ctrl-c typed at the prompt does not break in again
+	}
+
+	bool Debugger::Execute(const std::string &line)
+	{
+		std::istringstream ss(line);
+		std::string cmd, arg;
+		ss >> cmd;
+
+		u16 addr, n;
+		if (cmd.empty())
+			return true;
+		else if (cmd == "c" || cmd == "continue")
+			return false;
+		else if (cmd == "s" || cmd == "step")
+		{
+			_stepsLeft = (ss >> arg) && ParseNumber(arg, n) && n? n: 1;
+			return false;
+		}
+		else if (cmd == "q" || cmd == "quit")
+		{
+			_chip._running = false;
+			return false;
+		}
+		else if (cmd == "r" || cmd == "regs")
+			PrintState();
+		else if (cmd == "x")
+		{
+			if (!(ss >> arg) || !ParseNumber(arg, addr))
+				addr = _chip._i;
+			PrintMemory(addr, (ss >> arg) && ParseNumber(arg, n)? n: 16);
+		}
+		else if (cmd == "l" || cmd == "list")
+		{
+			if (!(ss >> arg) || !ParseNumber(arg, addr))
+				addr = _chip._pc;
+			PrintCode(addr, (ss >> arg) && ParseNumber(arg, n)? n: 10);
+		}
+		else if (cmd == "b" || cmd == "break")
+		{
+			if (!(ss >> arg) || !ParseNumber(arg, addr))
+			{
+				for(auto & bp : _conditions)
+					printf("0x%04x%s\n", bp.first, bp.second.ToString().c_str());
+				return true;
+			}
+
+			Condition cond = { Condition::Always, 0, Condition::EQ, 0 };
+			std::string kw, lhs, op, value;
+			if (ss >> kw)
+			{
+				static const char *ops[] = { "==", "!=", "<", ">", "<=", ">=" };
+				bool valid = kw == "if" && (ss >> lhs >> op >> value) && ParseNumber(value, cond.Value);
+				if (valid && lhs == "i")
+					cond.Lhs = Condition::Index;
+				else if (valid && ParseRegister(lhs, cond.Reg))
+					cond.Lhs = Condition::Register;
+				else
+					valid = false;
+
+				uint index = 0;
+				while(index < 6 && op != ops[index])
+					++index;
+				if (!valid || index == 6)
+				{
+					printf("syntax: b <addr> [if <vX|i> <==|!=|<|>|<=|>=> <value>]\n");
+					return true;
+				}
+				cond.Op = static_cast<Condition::Compare>(index);
+			}
+			_breakpoints[addr] = true;
+			_conditions[addr] = cond;
+		}
+		else if (cmd == "d" || cmd == "delete")
+		{
+			if ((ss >> arg) && ParseNumber(arg, addr))
+			{
+				_breakpoints[addr] = false;
+				_conditions.erase(addr);
+			}
+			else
+			{
+				for(auto & bp : _conditions)
+					_breakpoints[bp.first] = false;
+				_conditions.clear();
+			}
+		}
+		else if (cmd == "w" || cmd == "watch" || cmd == "unwatch")
+		{
+			if (ss >> arg)
+				Watch(arg, cmd != "unwatch");
+			else
+				printf("syntax: %s <addr[-end]|vX|i>\n", cmd.c_str());
+		}
+		else
+			Help();
+		return true;
+	}
+
+	void Debugger::Watch(const std::string &target, bool enable)
+	{
+		u8 reg;
+		u16 begin, end;
+		auto dash = target.find('-');
+		if (target == "i")
+		{
+			if (_watchedIndex != enable)
+				_watches += enable? 1: -1;
+			_watchedIndex = enable;
+		}
+		else if (ParseRegister(target, reg))
+		{
+			if (_watchedRegs[reg] != enable)
+				_watches += enable? 1: -1;
+			_watchedRegs[reg] = enable;
+		}
+		else if (ParseNumber(target.substr(0, dash), begin) && (dash == target.npos? (end = begin, true): ParseNumber(target.substr(dash + 1), end)) && begin <= end)
+		{
+			for(uint addr = begin; addr <= end; ++addr)
+			{
+				if (_watchedAddrs[addr] != enable)
+					_watches += enable? 1: -1;
+				_watchedAddrs[addr] = enable;
+			}
+			UpdatePages();
+		}
+		else
+			printf("invalid watch target %s\n", target.c_str());
+	}
+
+	void Debugger::UpdatePages()
+	{
+		for(uint page = 0; page < Memory::Pages; ++page)
+		{
+			bool watched = false;
+			for(uint addr = page * Memory::PageSize; !watched && addr < (page + 1) * Memory::PageSize; ++addr)
+				watched = _watchedAddrs[addr];
+			_chip._memory.WatchPage(page, watched);
+		}
+	}
+
+	void Debugger::Help()
+	{
+		printf(
+			"c, continue                   continue execution\n"
+			"s, step [n]                   execute n instructions\n"
+			"b, break [addr [if <cond>]]   list or set breakpoint, cond is <vX|i> <op> <value>\n"
+			"d, delete [addr]              delete breakpoint or all breakpoints\n"
+			"w, watch <addr[-end]|vX|i>    stop after memory range, register or i changes\n"
+			"unwatch <addr[-end]|vX|i>     remove watchpoint\n"
+			"r, regs                       print registers\n"
+			"x [addr [n]]                  dump memory, i by default\n"
+			"l, list [addr [n]]            disassemble, pc by default\n"
+			"q, quit                       stop emulation\n");
+	}
+
+	void Debugger::PrintState()
+	{
+		auto & c = _chip;
+		printf("pc 0x%04x i 0x%04x sp %u delay %u buzzer %u planes %u\n", c._pc, c._i, c._sp, c._delay, c._buzzer, c._planes);
+		for(uint r = 0; r < c._reg.size(); ++r)
+			printf("v%x 0x%02x%s", r, c._reg[r], (r & 7) == 7? "\n": " ");
+		if (c._sp)
+		{
+			printf("stack");
+			for(uint i = 0; i < c._sp; ++i)
+				printf(" 0x%04x", c._stack[i]);
+			printf("\n");
+		}
+	}
+
+	void Debugger::PrintMemory(u16 addr, uint n)
+	{
+		for(uint offset = 0; offset < n; offset += 16)
+		{
+			printf("%04x:", (u16)(addr + offset));
+			for(uint i = offset; i < n && i < offset + 16; ++i)
+				printf(" %02x", _chip._memory.Get(addr + i));
+			printf("\n");
+		}
+	}
+
+	void Debugger::PrintCode(u16 addr, uint n)
+	{
+		auto & memory = _chip._memory;
+		while(n--)
+		{
+			u16 op = memory.Get(addr) << 8 | memory.Get(addr + 1);
+			u16 next = memory.Get(addr + 2) << 8 | memory.Get(addr + 3);
+			printf("%c%s%04x: %04x %s\n", addr == _chip._pc? '>': ' ', _breakpoints[addr]? "*": " ", addr, op, Disassemble(op, next).c_str());
+			addr += GetInstructionSize(op);
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <chip8/Memory.h>
+#include <chip8/types.h>
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	class Chip8;
+
+	///interactive stdin debugger, interpreter switches to checked loop only while it's active
+	class Debugger : public Memory::Watcher
+	{
+		struct Condition
+		{
+			enum Operand { Always, Register, Index };
+			enum Compare { EQ, NE, LT, GT, LE, GE };
+
+			Operand		Lhs;
+			u8			Reg;
+			Compare		Op;
+			u16			Value;
+
+			bool Check(const Chip8 & chip) const;
+			std::string ToString() const;
+		};
+
+		Chip8 &							_chip;
+		std::vector<bool>				_breakpoints;
+		std::map<u16, Condition>		_conditions;
+		std::vector<bool>				_watchedAddrs;
+		std::array<bool, 16>			_watchedRegs;
+		bool							_watchedIndex;
+		uint							_watches;
+
+		bool							_paused;
+		uint							_stepsLeft;
+		int								_memoryHit;
+		std::array<u8, 16>				_reg;
+		u16								_i;
+
+		void Prompt(const std::string &reason);
+		bool Execute(const std::string &line);
+		void Watch(const std::string &target, bool enable);
+		void UpdatePages();
+		void Help();
+		void PrintState();
+		void PrintMemory(u16 addr, uint n);
+		void PrintCode(u16 addr, uint n);
+
+	public:
+		Debugger(Chip8 & chip);
+		~Debugger();
+
+		///stop before the next instruction
+		void Pause()
+		{ _paused = true; }
+
+		///ctrl-c pauses the running session instead of quitting, a second one before the pause quits
+		static void CatchInterrupt();
+		///turns pending ctrl-c into a pause, called once per frame
+		void CheckInterrupt();
+
+		bool IsActive() const
+		{ return _paused || _stepsLeft || !_conditions.empty() || _watches; }
+
+		void BeforeStep();
+		void AfterStep();
+
+		void OnWrite(u16 index, u8 value) override;
+	};
+}
+
+#endif
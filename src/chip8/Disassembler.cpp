@@ -0,0 +1,124 @@
+#include <chip8/Disassembler.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+namespace chip8
+{
+	namespace
+	{
+		std::string Format(const char *format, ...)
+		{
+			char buffer[64];
+			va_list args;
+			va_start(args, format);
+			vsnprintf(buffer, sizeof(buffer), format, args);
+			va_end(args);
+			return buffer;
+		}
+
+		std::string Invalid(u16 op)
+		{ return Format("invalid 0x%04x", op); }
+	}
+
+	std::string Disassemble(u16 op, u16 next)
+	{
+		u8 group = op >> 12;
+		u8 x = (op >> 8) & 0x0f;
+		u8 y = (op >> 4) & 0x0f;
+		u8 z = op & 0x0f;
+		u8 nn = op & 0xff;
+		u16 nnn = op & 0x0fff;
+
+		switch(group)
+		{
+		case 0x0:
+			if (x != 0)
+				return Invalid(op);
+			switch(nn)
+			{
+				case 0x00: return "halt";
+				case 0xc0 ... 0xcf: return Format("scroll-down %d", z);
+				case 0xd0 ... 0xdf: return Format("scroll-up %d", z);
+				case 0xe0: return "clear";
+				case 0xee: return "ret";
+				case 0xfb: return "scroll-right";
+				case 0xfc: return "scroll-left";
+				case 0xfd: return "exit";
+				case 0xfe: return "lores";
+				case 0xff: return "hires";
+				default: return Invalid(op);
+			}
+
+		case 0x1: return Format("jump 0x%04x", nnn);
+		case 0x2: return Format("call 0x%04x", nnn);
+		case 0x3: return Format("skip-eq v%x 0x%02x", x, nn);
+		case 0x4: return Format("skip-ne v%x 0x%02x", x, nn);
+
+		case 0x5:
+			switch(z)
+			{
+			case 0x0: return Format("skip-e v%x v%x", x, y);
+			case 0x2: return Format("save v%x-v%x", x, y);
+			case 0x3: return Format("load v%x-v%x", x, y);
+			case 0xf: return Format("dump v%x-v%x", x, y);
+			default: return Invalid(op);
+			}
+
+		case 0x6: return Format("v%x := 0x%02x", x, nn);
+		case 0x7: return Format("v%x += 0x%02x", x, nn);
+
+		case 0x8:
+			switch(z)
+			{
+			case 0x0: return Format("v%x = v%x", x, y);
+			case 0x1: return Format("v%x |= v%x", x, y);
+			case 0x2: return Format("v%x &= v%x", x, y);
+			case 0x3: return Format("v%x ^= v%x", x, y);
+			case 0x4: return Format("v%x += v%x", x, y);
+			case 0x5: return Format("v%x -= v%x", x, y);
+			case 0x6: return Format("v%x >> v%x", x, y);
+			case 0x7: return Format("v%x =- v%x", x, y);
+			case 0xe: return Format("v%x << v%x", x, y);
+			default: return Invalid(op);
+			}
+
+		case 0x9:
+			return z == 0? Format("skip-ne v%x v%x", x, y): Invalid(op);
+
+		case 0xa: return Format("i := 0x%04x", nnn);
+		case 0xb: return Format("jump0 0x%04x", nnn);
+		case 0xc: return Format("random %u", nn);
+		case 0xd: return Format("sprite v%x v%x %u", x, y, z);
+
+		case 0xe:
+			switch(nn)
+			{
+			case 0x9e: return Format("skip v%x key", x);
+			case 0xa1: return Format("skip v%x -key", x);
+			default: return Invalid(op);
+			}
+
+		case 0xf:
+			switch(nn)
+			{
+			case 0x00: return x == 0? Format("i := long 0x%04x", next): Invalid(op);
+			case 0x01: return Format("plane %u", x);
+			case 0x02: return "audio";
+			case 0x07: return Format("v%x = delay", x);
+			case 0x0a: return Format("v%x := key", x);
+			case 0x15: return Format("delay := v%x", x);
+			case 0x18: return Format("buzzer := v%x", x);
+			case 0x1e: return Format("i += v%x", x);
+			case 0x29: return Format("i = hex v%x", x);
+			case 0x30: return Format("i = bighex v%x", x);
+			case 0x33: return Format("bcd v%x", x);
+			case 0x55: return Format("save v%x", x);
+			case 0x65: return Format("load v%x", x);
+			case 0x75: return Format("saveflags v%x", x);
+			case 0x85: return Format("loadflags v%x", x);
+			default: return Invalid(op);
+			}
+		}
+		return Invalid(op);
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef DISASSEMBLER_H
+#define DISASSEMBLER_H
+
+#include <chip8/types.h>
+#include <string>
+
+namespace chip8
+{
+	///mnemonic for op, next is the following word used by long i assignment (f000 nnnn)
+	std::string Disassemble(u16 op, u16 next = 0);
+
+	///size of instruction in bytes, 4 for long i assignment
+	inline uint GetInstructionSize(u16 op)
+	{ return op == 0xf000? 4: 2; }
+}
+
+#endif
@@ -2,10 +2,12 @@
 #define FILE_H
 
 #include <chip8/types.h>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <stdio.h>
+#include <dirent.h>
 #include <fcntl.h>           /* Definition of AT_* constants */
 #include <unistd.h>
 
@@ -56,6 +58,24 @@ namespace chip8
 		static bool Exists(const std::string &path)
 		{ return access(path.c_str(), F_OK) == 0; }
 
+		///sorted paths of directory entries ending with suffix
+		static std::vector<std::string> List(const std::string &dir, const std::string &suffix)
+		{
+			std::vector<std::string> files;
+			DIR *d = opendir(dir.c_str());
+			if (!d)
+				throw std::runtime_error("could not open directory " + dir);
+			while(auto entry = readdir(d))
+			{
+				std::string name = entry->d_name;
+				if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+					files.push_back(dir + "/" + name);
+			}
+			closedir(d);
+			std::sort(files.begin(), files.end());
+			return files;
+		}
+
 	};
 
 }
@@ -0,0 +1,94 @@
+#include <chip8/FlagStore.h>
+#include <chip8/File.h>
+#include <chip8/Timeline.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	FlagStore::FlagStore(): _stop(false)
+	{ _thread = std::thread([this]() { Run(); }); }
+
+	FlagStore::~FlagStore()
+	{
+		{
+			std::lock_guard<std::mutex> l(_lock);
+			_stop = true;
+		}
+		_changed.notify_one();
+		_thread.join();
+
+		std::set<std::string> dirs;
+		for(auto &path : _written)
+		{
+			SyncFile(path);
+			auto slash = path.rfind('/');
+			dirs.insert(slash != path.npos? path.substr(0, slash): ".");
+		}
+		for(auto &dir : dirs)
+			SyncFile(dir); //make renames durable
+	}
+
+	void FlagStore::Write(const std::string &path, const u8 *data, size_t size)
+	{
+		Data value(data, data + size);
+		{
+			std::lock_guard<std::mutex> l(_lock);
+			auto latest = _latest.find(path);
+			if (latest != _latest.end() && latest->second == value)
+				return;
+			_latest[path] = value;
+			_pending[path] = std::move(value);
+		}
+		_changed.notify_one();
+	}
+
+	void FlagStore::Run()
+	{
+		Timeline::SetThreadName("flags");
+		std::unique_lock<std::mutex> l(_lock);
+		while(true)
+		{
+			_changed.wait(l, [this]() { return _stop || !_pending.empty(); });
+			if (_pending.empty() && _stop)
+				break;
+
+			std::map<std::string, Data> pending;
+			pending.swap(_pending);
+			l.unlock();
+			for(auto &file : pending)
+				WriteFile(file.first, file.second);
+			l.lock();
+			for(auto &file : pending)
+				_written.insert(file.first);
+		}
+	}
+
+	void FlagStore::WriteFile(const std::string &path, const Data &data)
+	{
+		Timeline::Zone zone("WriteFlags");
+		try
+		{
+			auto temp = path + ".tmp";
+			{
+				File file(temp, "wb");
+				file.Write(data.data(), data.size());
+			}
+			if (rename(temp.c_str(), path.c_str()) != 0)
+				perror(("rename " + temp).c_str());
+		}
+		catch(const std::exception &ex)
+		{ fprintf(stderr, "could not save %s: %s\n", path.c_str(), ex.what()); }
+	}
+
+	void FlagStore::SyncFile(const std::string &path)
+	{
+		Timeline::Zone zone("SyncFlags");
+		int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return;
+		fsync(fd);
+		close(fd);
+	}
+}
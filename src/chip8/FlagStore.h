@@ -0,0 +1,44 @@
+#ifndef FLAGSTORE_H
+#define FLAGSTORE_H
+
+#include <chip8/types.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chip8
+{
+	///persists small files on background thread, repeated writes of the same path are coalesced to the latest data
+	///files are replaced by atomic rename, destructor writes what is pending and fsyncs everything written
+	class FlagStore
+	{
+		using Data = std::vector<u8>;
+
+		std::mutex						_lock;
+		std::condition_variable			_changed;
+		std::map<std::string, Data>		_pending;
+		std::map<std::string, Data>		_latest;	//last queued contents, identical writes are dropped
+		std::set<std::string>			_written;
+		bool							_stop;
+		std::thread						_thread;
+
+		void Run();
+		static void WriteFile(const std::string &path, const Data &data);
+		static void SyncFile(const std::string &path);
+
+	public:
+		FlagStore();
+		~FlagStore();
+
+		FlagStore(const FlagStore &) = delete;
+		FlagStore& operator = (const FlagStore &) = delete;
+
+		void Write(const std::string &path, const u8 *data, size_t size);
+	};
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include <chip8/FrameScheduler.h>
+#include <chip8/Metrics.h>
+#include <thread>
+
+namespace chip8
+{
+	void FrameScheduler::BeginFrame()
+	{
+		if (_deadline == clock::time_point())
+			_deadline = clock::now() + _period;
+	}
+
+	bool FrameScheduler::Skip(uint maxSkip)
+	{
+		if (_skipped >= maxSkip)
+			return false;
+		++_skipped;
+		++_stats.Skipped;
+		Metrics::Add(Metrics::Counter::SkippedFrames);
+		return true;
+	}
+
+	void FrameScheduler::OnRendered()
+	{
+		_skipped = 0;
+		++_stats.Rendered;
+		Metrics::Add(Metrics::Counter::RenderedFrames);
+	}
+
+	void FrameScheduler::OnElided()
+	{
+		++_stats.Elided;
+		Metrics::Add(Metrics::Counter::ElidedFrames);
+	}
+
+	void FrameScheduler::Wait()
+	{
+		auto now = clock::now();
+		if (now < _deadline)
+			std::this_thread::sleep_until(_deadline);
+		else if (now - _deadline > MaxLag * _period)
+		{
+			//debugger pause, suspended process or hopelessly slow host, catching up would fast forward
+			u64 lost = (now - _deadline) / _period;
+			_stats.Dropped += lost;
+			Metrics::Add(Metrics::Counter::DroppedFrames, lost);
+			_deadline = now;
+		}
+		_deadline += _period;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <chip8/types.h>
+#include <chrono>
+
+namespace chip8
+{
+	///keeps frames on a fixed 60Hz grid, a slow frame is made up by the following ones instead of slowing the guest down
+	///changed frames finishing past their deadline are not presented, at most maxSkip in a row
+	///falling more than MaxLag frames behind re-anchors the grid, those guest frames are lost
+	class FrameScheduler
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+		static constexpr uint MaxLag = 8;
+
+		struct Stats
+		{
+			u64 Rendered;	//presented by backend
+			u64 Elided;		//framebuffer unchanged, nothing to present
+			u64 Skipped;	//changed, not presented to catch up with schedule
+			u64 Dropped;	//guest frames lost re-anchoring the schedule
+		};
+
+	private:
+		clock::duration		_period;
+		clock::time_point	_deadline;	//end of current frame, unset until first frame
+		uint				_skipped;	//consecutive skipped frames
+		Stats				_stats;
+
+	public:
+		FrameScheduler(clock::duration period): _period(period), _skipped(0), _stats() { }
+
+		///starts a frame, first frame anchors the grid
+		void BeginFrame();
+
+		///start of given part of current frame split into slices
+		clock::time_point GetSliceTime(uint slice, uint slices) const
+		{ return _deadline - _period + _period * slice / slices; }
+
+		///current frame missed its deadline already
+		bool IsLate() const
+		{ return clock::now() > _deadline; }
+
+		///true if a late frame may be skipped
+		bool Skip(uint maxSkip);
+		void OnRendered();
+		void OnElided();
+
+		///sleeps until end of current frame
+		void Wait();
+
+		const Stats & GetStats() const
+		{ return _stats; }
+	};
+}
+
+#endif
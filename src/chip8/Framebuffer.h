@@ -1,6 +1,7 @@
 #ifndef FRAMEBUFFER_H
 #define FRAMEBUFFER_H
 
+#include <chip8/State.h>
 #include <chip8/types.h>
 #include <array>
 #include <algorithm>
@@ -19,6 +20,7 @@ namespace chip8
 	private:
 		u8		_w, _h;
 		u16		_size;
+		bool	_dirty; //any pixel changed since ResetDirty
 
 		std::array<u8, MaxSize> _data;
 
@@ -43,14 +45,23 @@ namespace chip8
 		void Invalidate() {
 			for(auto & pixel : _data)
 				pixel |= DirtyBit;
+			_dirty = true;
 		}
 
+		///cheap whole-frame check, per-pixel DirtyBit is left to backends
+		bool IsDirty() const
+		{ return _dirty; }
+
+		void ResetDirty()
+		{ _dirty = false; }
+
 		bool Write(u8 plane, u8 y, u8 x, u8 value)
 		{
 			if (value == 0)
 				return false;
 			//quirks, clip
 			bool collision = false;
+			_dirty = true;
 
 			u8 planeMask = 1 << plane;
 
@@ -80,11 +91,47 @@ namespace chip8
 		void Clear()
 		{
 			std::fill(_data.begin(), _data.end(), static_cast<u8>(DirtyBit));
+			_dirty = true;
 		}
 
 		u8 *GetLine(uint y)
 		{ return _data.data() + y * _w; }
 
+		///row-major pixels, low two bits are planes, DirtyBit marks pixels changed since last render
+		const u8 *GetData() const
+		{ return _data.data(); }
+
+		void SaveState(StateWriter &writer) const
+		{
+			writer.Write8(_w);
+			writer.Write8(_h);
+			for(u16 i = 0; i < _size; ++i)
+				writer.Write8(_data[i] & 0x03);
+		}
+
+		void LoadState(StateReader &reader)
+		{
+			u8 w = reader.Read8(), h = reader.Read8();
+			if (w == 0 || h == 0 || w > MaxWidth || h > MaxHeight)
+				throw std::runtime_error("invalid framebuffer state");
+			SetResolution(w, h);
+			reader.Read(_data.data(), _size);
+			for(u16 i = 0; i < _size; ++i)
+				_data[i] = (_data[i] & 0x03) | DirtyBit;
+		}
+
+		///FNV-1a hash of resolution and plane bits, dirty bits are ignored
+		u64 Hash() const
+		{
+			u64 hash = 0xcbf29ce484222325ull;
+			auto mix = [&hash](u8 value) { hash = (hash ^ value) * 0x100000001b3ull; };
+			mix(_w);
+			mix(_h);
+			for(u16 i = 0; i < _size; ++i)
+				mix(_data[i] & 0x03);
+			return hash;
+		}
+
 		void Scroll(int dx, int dy)
 		{
 			if ((dx | dy) == 0)
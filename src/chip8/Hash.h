@@ -0,0 +1,20 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <chip8/types.h>
+#include <stddef.h>
+
+namespace chip8
+{
+	///64-bit FNV-1a, pass previous result as seed to hash several buffers
+	inline u64 Hash(const void *data, size_t size, u64 seed = 0xcbf29ce484222325ull)
+	{
+		auto bytes = static_cast<const u8 *>(data);
+		u64 hash = seed;
+		for(size_t i = 0; i < size; ++i)
+			hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+		return hash;
+	}
+}
+
+#endif
@@ -0,0 +1,191 @@
+#include <chip8/Host.h>
+#include <chip8/Chip8.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	namespace
+	{
+		void AddFd(int epoll, int fd)
+		{
+			epoll_event event = {};
+			event.events = EPOLLIN;
+			event.data.fd = fd;
+			if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+				throw std::runtime_error(std::string("epoll_ctl: ") + strerror(errno));
+		}
+	}
+
+	Host::Host(uint threads): _stop(false)
+	{
+		if (threads == 0)
+			threads = 1;
+
+		itimerspec period = {};
+		period.it_interval.tv_nsec = Chip8::TimerPeriodMs * 1000;
+		period.it_value = period.it_interval;
+
+		for(uint i = 0; i < threads; ++i)
+		{
+			std::unique_ptr<Worker> worker(new Worker());
+			worker->Epoll = epoll_create1(EPOLL_CLOEXEC);
+			worker->Timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+			worker->Wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			_workers.push_back(std::move(worker));
+			auto &w = *_workers.back();
+			if (w.Epoll < 0 || w.Timer < 0 || w.Wakeup < 0)
+				throw std::runtime_error(std::string("could not create host thread descriptors: ") + strerror(errno));
+			if (timerfd_settime(w.Timer, 0, &period, nullptr) != 0)
+				throw std::runtime_error(std::string("timerfd_settime: ") + strerror(errno));
+			AddFd(w.Epoll, w.Timer);
+			AddFd(w.Epoll, w.Wakeup);
+		}
+		try
+		{
+			for(auto &worker : _workers)
+			{
+				Worker *w = worker.get();
+				w->Thread = std::thread([this, w]() { Run(*w); });
+			}
+		}
+		catch(...)
+		{
+			Stop(); //destroying joinable threads would terminate
+			throw;
+		}
+	}
+
+	Host::~Host()
+	{ Stop(); }
+
+	Host::Worker::~Worker()
+	{
+		for(int fd : { Epoll, Timer, Wakeup })
+			if (fd >= 0)
+				close(fd);
+	}
+
+	void Host::Stop()
+	{
+		_stop = true;
+		for(auto &worker : _workers)
+		{
+			Wake(*worker);
+			if (worker->Thread.joinable())
+				worker->Thread.join();
+		}
+	}
+
+	void Host::Wake(Worker &worker)
+	{
+		u64 one = 1;
+		if (write(worker.Wakeup, &one, sizeof(one)) != sizeof(one))
+			{ } //counter saturated, worker is awake anyway
+	}
+
+	void Host::Add(Chip8 &chip)
+	{
+		auto worker = std::min_element(_workers.begin(), _workers.end(),
+			[](const std::unique_ptr<Worker> &a, const std::unique_ptr<Worker> &b) { return a->Count < b->Count; });
+		auto &w = **worker;
+		++w.Count;
+		{
+			std::lock_guard<std::mutex> l(w.Lock);
+			w.Pending.push_back(&chip);
+		}
+		Wake(w);
+	}
+
+	void Host::Wait()
+	{
+		std::unique_lock<std::mutex> l(_lock);
+		_finished.wait(l, [this]() {
+			for(auto &worker : _workers)
+				if (worker->Count)
+					return false;
+			return true;
+		});
+	}
+
+	Host::Stats Host::GetStats() const
+	{
+		Stats stats = {};
+		for(auto &worker : _workers)
+		{
+			stats.Instances		+= worker->Count;
+			stats.Frames		+= worker->Frames;
+			stats.MissedTicks	+= worker->MissedTicks;
+			stats.Faults		+= worker->Faults;
+		}
+		return stats;
+	}
+
+	void Host::Tick(Worker &worker)
+	{
+		auto &instances = worker.Instances;
+		size_t before = instances.size();
+		instances.erase(std::remove_if(instances.begin(), instances.end(),
+			[&worker](Chip8 *chip) {
+				//one broken rom must not take the whole thread down
+				bool running = false, failed = false;
+				try
+				{ running = chip->AdvanceFrame() && chip->Render(); }
+				catch(const std::exception &)
+				{ failed = true; }
+				if (failed || chip->GetFault() != Fault::None)
+					++worker.Faults;
+				return !running;
+			}), instances.end());
+		worker.Frames += before;
+
+		if (instances.size() != before)
+		{
+			{
+				std::lock_guard<std::mutex> l(_lock);
+				worker.Count -= before - instances.size();
+			}
+			_finished.notify_all();
+		}
+	}
+
+	void Host::Run(Worker &worker)
+	{
+		static constexpr int MaxEvents = 2;
+		epoll_event events[MaxEvents];
+		while(!_stop)
+		{
+			int n = epoll_wait(worker.Epoll, events, MaxEvents, -1);
+			if (n < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				break;
+			}
+			for(int i = 0; i < n; ++i)
+			{
+				u64 value;
+				if (read(events[i].data.fd, &value, sizeof(value)) != sizeof(value))
+					continue;
+
+				if (events[i].data.fd == worker.Wakeup)
+				{
+					std::lock_guard<std::mutex> l(worker.Lock);
+					worker.Instances.insert(worker.Instances.end(), worker.Pending.begin(), worker.Pending.end());
+					worker.Pending.clear();
+				}
+				else
+				{
+					//value is number of expirations, anything above one was missed
+					worker.MissedTicks += value - 1;
+					Tick(worker);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <chip8/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chip8
+{
+	class Chip8;
+
+	///runs many instances at 60Hz on a few threads, each thread waits on epoll for its timerfd and wakeup eventfd
+	///every tick advances and renders all instances of the thread, missed ticks are skipped and counted
+	class Host
+	{
+		struct Worker
+		{
+			int						Epoll;
+			int						Timer;
+			int						Wakeup;
+			std::thread				Thread;
+
+			std::mutex				Lock;
+			std::vector<Chip8 *>	Pending;	//added from other threads
+			std::vector<Chip8 *>	Instances;	//owned by worker thread
+
+			std::atomic<size_t>		Count;
+			std::atomic<u64>		Frames;
+			std::atomic<u64>		MissedTicks;
+			std::atomic<u64>		Faults;
+
+			Worker(): Epoll(-1), Timer(-1), Wakeup(-1), Count(0), Frames(0), MissedTicks(0), Faults(0) { }
+			///closes descriptors, also when Host constructor fails halfway
+			~Worker();
+		};
+
+		std::vector<std::unique_ptr<Worker>>	_workers;
+		std::atomic<bool>						_stop;
+		std::mutex								_lock;
+		std::condition_variable					_finished;
+
+		void Run(Worker &worker);
+		void Tick(Worker &worker);
+		static void Wake(Worker &worker);
+		///stops and joins worker threads, descriptors are closed by ~Worker
+		void Stop();
+
+	public:
+		struct Stats
+		{
+			size_t	Instances;
+			u64		Frames;
+			u64		MissedTicks;	//timer expirations not processed in time, summed over threads
+			u64		Faults;			//instances removed after a fault or exception
+		};
+
+		explicit Host(uint threads);
+		~Host();
+
+		Host(const Host &) = delete;
+		Host& operator = (const Host &) = delete;
+
+		///hands instance over to least loaded thread, it runs until AdvanceFrame or Render returns false
+		///an instance which faults or throws is removed like a halted one and counted in Stats::Faults, others keep running
+		void Add(Chip8 &chip);
+
+		///blocks until every added instance has finished
+		void Wait();
+
+		Stats GetStats() const;
+	};
+}
+
+#endif
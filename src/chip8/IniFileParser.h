@@ -2,84 +2,114 @@
 #define INIFILEPARSER_H
 
 #include <string>
+#include <string_view>
 #include <stdexcept>
 
 namespace chip8
 {
-	namespace
-	{ const char *WS = " \n\r\t\f"; }
-
+	///parses ini text in place, handler gets views into the parsed buffer valid only during OnValue call
 	template<typename Handler>
 	class IniFileParser
 	{
 	private:
-		std::string _currentSection;
+		using size_type = std::string_view::size_type;
+
+		std::string_view _text;
+		std::string_view _currentSection;
+
+		static bool IsWS(char c)
+		{ return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\n'; }
 
-		size_t Section(const std::string &text, size_t pos)
+		static bool IsBlank(char c)
+		{ return c == ' ' || c == '\t' || c == '\r' || c == '\f'; }
+
+		///line and column are computed only when reporting an error
+		[[noreturn]] void Error(size_type pos, const std::string &message) const
 		{
-			auto end = text.find(']', pos);
-			if (end == text.npos)
-				throw std::runtime_error("unexpected end while reading section name");
-			
-			_currentSection = text.substr(pos + 1, end - pos - 1);
-			return NextLine(text, end + 1);
+			size_type line = 1, column = 1;
+			for(size_type i = 0; i < pos && i < _text.size(); ++i)
+			{
+				if (_text[i] == '\n')
+				{
+					++line;
+					column = 1;
+				}
+				else
+					++column;
+			}
+			throw std::runtime_error("line " + std::to_string(line) + ", column " + std::to_string(column) + ": " + message);
 		}
 
-		size_t Value(const std::string &text, size_t pos)
+		size_type LineEnd(size_type pos) const
 		{
-			auto eq = text.find('=', pos);
-			if (eq == text.npos)
-				throw std::runtime_error("unexpected end while reading value name");
-
-			auto nameEnd = text.find_last_not_of(WS, eq - 1, eq - pos);
-			std::string name = text.substr(pos, nameEnd - pos + 1);
+			auto end = _text.find('\n', pos);
+			return end != _text.npos? end: _text.size();
+		}
 
-			pos = SkipWS(text, eq + 1);
+		std::string_view Trim(size_type begin, size_type end) const
+		{
+			while(begin < end && IsBlank(_text[begin]))
+				++begin;
+			while(end > begin && IsBlank(_text[end - 1]))
+				--end;
+			return _text.substr(begin, end - begin);
+		}
 
-			auto lineEnd = text.find('\n', pos);
-			if (lineEnd == text.npos)
-				lineEnd = text.size();
+		size_type Section(size_type pos)
+		{
+			auto lineEnd = LineEnd(pos);
+			auto end = _text.find(']', pos);
+			if (end == _text.npos || end > lineEnd)
+				Error(pos, "missing ']' after section name");
 
-			auto valueEnd = text.find_last_not_of(WS, lineEnd);
-			std::string value = text.substr(pos, valueEnd - pos + 1);
-			//printf("result : '%s' '%s'\n", name.c_str(), value.c_str());
-			static_cast<Handler *>(this)->OnValue(_currentSection, name, value);
+			_currentSection = Trim(pos + 1, end);
 			return lineEnd + 1;
 		}
 
-		using size_type = std::string::size_type;
-
-		size_t SkipWS(const std::string &text, size_t pos)
+		size_type Value(size_type pos)
 		{
-			auto next = text.find_first_not_of(WS, pos);
-			return next != text.npos? next: text.size();
-		}
+			auto lineEnd = LineEnd(pos);
+			auto eq = _text.find('=', pos);
+			if (eq == _text.npos || eq > lineEnd)
+				Error(pos, "expected '=' after value name");
 
-		size_t NextLine(const std::string &text, size_t pos)
-		{
-			auto next = text.find('\n', pos);
-			return next != text.npos? next + 1: text.size();
+			auto name = Trim(pos, eq);
+			if (name.empty())
+				Error(pos, "empty value name");
+			auto value = Trim(eq + 1, lineEnd);
+			try
+			{ static_cast<Handler *>(this)->OnValue(_currentSection, name, value); }
+			catch(const std::runtime_error &ex)
+			{ Error(value.data() - _text.data(), ex.what()); }
+			return lineEnd + 1;
 		}
 
 	public:
-		void Parse(const std::string &text)
+		void Parse(std::string_view text)
 		{
-			for(size_type pos = 0; pos < text.size(); )
+			_text = text;
+			for(size_type pos = 0; pos < _text.size(); )
 			{
-				pos = SkipWS(text, pos);
-				switch(text[pos])
+				while(pos < _text.size() && IsWS(_text[pos]))
+					++pos;
+				if (pos >= _text.size())
+					break;
+
+				switch(_text[pos])
 				{
 				case ';':
 				case '#':
-					pos = NextLine(text, pos);
+					pos = LineEnd(pos) + 1;
 					break;
 				case '[':
-					pos = Section(text, pos);
+					pos = Section(pos);
 					break;
 				default:
-					pos = Value(text, pos);
+					pos = Value(pos);
 				}
 			}
+			_currentSection = std::string_view();
+			_text = std::string_view();
 		}
 	};
 }
@@ -0,0 +1,66 @@
+#ifndef KEYQUEUE_H
+#define KEYQUEUE_H
+
+#include <chip8/types.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+namespace chip8
+{
+	///key transitions stamped with the time they happened, applied once the emulator reaches that time
+	///producers may push from any thread, Apply and Get belong to the emulator thread
+	class KeyQueue
+	{
+	public:
+		using clock = std::chrono::steady_clock;
+
+	private:
+		struct Event
+		{
+			clock::time_point	Time;
+			u8					Key;
+			bool				Pressed;
+		};
+
+		std::mutex			_lock;
+		std::deque<Event>	_events;
+		u16					_state;
+
+	public:
+		KeyQueue(): _state(0) { }
+
+		void Push(u8 key, bool pressed, clock::time_point time = clock::now())
+		{
+			std::lock_guard<std::mutex> l(_lock);
+			_events.push_back({ time, key, pressed });
+		}
+
+		///applies events up to time, a key pressed and released in between stays down until the next call
+		void Apply(clock::time_point time)
+		{
+			std::lock_guard<std::mutex> l(_lock);
+			u16 pressed = 0;
+			while(!_events.empty() && _events.front().Time <= time)
+			{
+				auto &event = _events.front();
+				u16 mask = 1 << event.Key;
+				if (event.Pressed)
+				{
+					_state |= mask;
+					pressed |= mask;
+				}
+				else if (pressed & mask)
+					break; //later events keep their order
+				else
+					_state &= ~mask;
+				_events.pop_front();
+			}
+		}
+
+		bool Get(u8 index) const
+		{ return index < 16 && (_state & (1 << index)); }
+	};
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <chip8/types.h>
+#include <string>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	///read-only private mapping of the whole file, empty files map to null
+	class MappedFile
+	{
+		const u8 *	_data;
+		size_t		_size;
+
+	public:
+		MappedFile(const std::string &path): _data(nullptr), _size(0)
+		{
+			int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				throw std::runtime_error("could not open file " + path);
+			struct stat st;
+			if (fstat(fd, &st) != 0)
+			{
+				close(fd);
+				throw std::runtime_error("could not stat file " + path);
+			}
+			_size = st.st_size;
+			if (_size)
+			{
+				void *data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data == MAP_FAILED)
+				{
+					close(fd);
+					throw std::runtime_error("could not map file " + path);
+				}
+				_data = static_cast<const u8 *>(data);
+			}
+			close(fd);
+		}
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile& operator = (const MappedFile &) = delete;
+
+		~MappedFile()
+		{
+			if (_data)
+				munmap(const_cast<u8 *>(_data), _size);
+		}
+
+		const u8 *GetData() const
+		{ return _data; }
+
+		size_t GetSize() const
+		{ return _size; }
+	};
+}
+
+#endif
@@ -1,8 +1,11 @@
 #include <chip8/Memory.h>
+#include <chip8/State.h>
+#include <algorithm>
+#include <string.h>
 
 namespace chip8
 {
-	void Memory::Reset()
+	Memory::Memory(): _image(), _pages(), _imageEnd(BigFontOffset + BigFontSize), _watcher(nullptr)
 	{
 		static const u8 font [] =
 		{
@@ -42,9 +45,62 @@ namespace chip8
 			0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
 			0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
 		};
-		std::copy(font, font + FontSize, _data.data() + FontOffset);
-		std::copy(bigFont, bigFont + BigFontSize, _data.data() + BigFontOffset);
-		std::fill(_data.begin() + BigFontOffset, _data.end(), 0);
+		std::copy(font, font + FontSize, _image.data() + FontOffset);
+		std::copy(bigFont, bigFont + BigFontSize, _image.data() + BigFontOffset);
+		_data = _image;
+	}
+
+	void Memory::Reset()
+	{
+		for(uint page = 0; page < Pages; ++page)
+			if (_pages[page] & PageDirty)
+			{
+				memcpy(_data.data() + page * PageSize, _image.data() + page * PageSize, PageSize);
+				_pages[page] &= ~PageDirty;
+			}
+	}
+
+	void Memory::Load(u16 offset, const u8 *data, size_t size)
+	{
+		static constexpr uint FontEnd = BigFontOffset + BigFontSize;
+		size = std::min<size_t>(size, Size - offset);
+		uint end = offset + size;
+
+		//image keeps only fonts and this rom, previous one may be longer
+		std::fill(_image.begin() + FontEnd, _image.begin() + _imageEnd, 0);
+		std::copy(data, data + size, _image.begin() + offset);
+		MarkDirty(FontEnd, std::max(_imageEnd, end));
+		_imageEnd = std::max(end, FontEnd);
+		Reset();
+	}
+
+	void Memory::SaveState(StateWriter &writer) const
+	{
+		u16 count = 0;
+		for(auto flags : _pages)
+			if (flags & PageDirty)
+				++count;
+		writer.Write16(count);
+		for(uint page = 0; page < Pages; ++page)
+			if (_pages[page] & PageDirty)
+			{
+				writer.Write8(page);
+				writer.Write(_data.data() + page * PageSize, PageSize);
+			}
+	}
+
+	void Memory::LoadState(StateReader &reader)
+	{
+		Reset();
+		uint count = reader.Read16();
+		if (count > Pages)
+			throw std::runtime_error("invalid memory state");
+		while(count--)
+		{
+			u8 page = reader.Read8();
+			reader.Read(_data.data() + page * PageSize, PageSize);
+			_pages[page] |= PageDirty;
+		}
 	}
 
-}
+}
\ No newline at end of file
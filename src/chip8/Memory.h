@@ -3,9 +3,13 @@
 
 #include <chip8/types.h>
 #include <array>
+#include <stddef.h>
 
 namespace chip8
 {
+	class StateReader;
+	class StateWriter;
+
 	class Memory
 	{
 	public:
@@ -15,13 +19,56 @@ namespace chip8
 		static constexpr u16 BigFontOffset	= FontOffset + FontSize;
 		static constexpr u16 BigFontSize	= 10 * 16;
 
+		static constexpr uint PageSize		= 0x100;
+		static constexpr uint Pages			= Size / PageSize;
+
+		class Watcher
+		{
+		public:
+			virtual ~Watcher() { }
+			virtual void OnWrite(u16 index, u8 value) = 0;
+		};
+
 	private:
+		static constexpr u8 PageDirty	= 1; //differs from image since last reset
+		static constexpr u8 PageWatched	= 2; //writes to these pages are reported to watcher
+
 		std::array<u8, Size> _data;
+		std::array<u8, Size> _image; //fonts and loaded rom, restored by reset
+		std::array<u8, Pages> _pages;
+		uint _imageEnd;
+		Watcher * _watcher;
+
+		void MarkDirty(uint begin, uint end)
+		{
+			for(uint page = begin / PageSize; page < (end + PageSize - 1) / PageSize; ++page)
+				_pages[page] |= PageDirty;
+		}
 
 	public:
+		Memory();
 
+		///restores fonts and loaded rom, copies only pages written since last reset
 		void Reset();
 
+		///places rom into image at offset and resets
+		void Load(u16 offset, const u8 *data, size_t size);
+
+		///snapshot stores only pages that differ from image
+		void SaveState(StateWriter &writer) const;
+		void LoadState(StateReader &reader);
+
+		void SetWatcher(Watcher * watcher)
+		{ _watcher = watcher; }
+
+		void WatchPage(uint page, bool watch)
+		{
+			if (watch)
+				_pages[page] |= PageWatched;
+			else
+				_pages[page] &= ~PageWatched;
+		}
+
 		u8 Get(u16 index)
 		{ return _data[index]; }
 
@@ -29,10 +76,13 @@ namespace chip8
 		{ return _data[index]; }
 
 		void Set(u16 index, u8 value)
-		{ _data[index] = value; }
-
-		u8 * GetData()
-		{ return _data.data(); }
+		{
+			_data[index] = value;
+			u8 &page = _pages[index / PageSize];
+			if (page & PageWatched)
+				_watcher->OnWrite(index, value);
+			page |= PageDirty;
+		}
 
 		const u8 * GetData() const
 		{ return _data.data(); }
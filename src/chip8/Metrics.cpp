@@ -0,0 +1,192 @@
+#include <chip8/Metrics.h>
+#include <chip8/File.h>
+#include <memory>
+#include <sstream>
+#include <stdio.h>
+#include <vector>
+
+namespace chip8
+{
+	namespace
+	{
+		std::mutex & GetShardsLock()
+		{
+			static std::mutex lock;
+			return lock;
+		}
+
+		template<typename Shard>
+		std::vector<std::unique_ptr<Shard>> & GetShards()
+		{
+			static std::vector<std::unique_ptr<Shard>> shards;
+			return shards;
+		}
+
+		bool EndsWith(const std::string &str, const std::string &suffix)
+		{ return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0; }
+	}
+
+	Metrics::Shard::Shard()
+	{
+		for(auto &value : Counters)
+			value = 0;
+		for(uint i = 0; i < HistogramCount; ++i)
+		{
+			Counts[i] = 0;
+			Sums[i] = 0;
+			for(auto &value : Buckets[i])
+				value = 0;
+		}
+	}
+
+	Metrics::Shard * Metrics::Register()
+	{
+		std::lock_guard<std::mutex> l(GetShardsLock());
+		auto &shards = GetShards<Shard>();
+		shards.emplace_back(new Shard());
+		return shards.back().get();
+	}
+
+	Metrics::Snapshot Metrics::Collect()
+	{
+		Snapshot snapshot = {};
+		std::lock_guard<std::mutex> l(GetShardsLock());
+		for(auto &shard : GetShards<Shard>())
+		{
+			for(uint i = 0; i < CounterCount; ++i)
+				snapshot.Counters[i] += shard->Counters[i].load(std::memory_order_relaxed);
+			for(uint i = 0; i < HistogramCount; ++i)
+			{
+				auto &histogram = snapshot.Histograms[i];
+				histogram.Count += shard->Counts[i].load(std::memory_order_relaxed);
+				histogram.Sum += shard->Sums[i].load(std::memory_order_relaxed);
+				for(uint b = 0; b < BucketCount; ++b)
+					histogram.Buckets[b] += shard->Buckets[i][b].load(std::memory_order_relaxed);
+			}
+		}
+		return snapshot;
+	}
+
+	const char * Metrics::GetName(Counter counter)
+	{
+		switch(counter)
+		{
+		case Counter::Frames:			return "frames";
+		case Counter::Instructions:		return "instructions";
+		case Counter::Sprites:			return "sprites";
+		case Counter::Collisions:		return "collisions";
+		case Counter::Scrolls:			return "scrolls";
+		case Counter::AudioCallbacks:	return "audio_callbacks";
+		case Counter::RenderedFrames:	return "frames_rendered";
+		case Counter::ElidedFrames:		return "frames_elided";
+		case Counter::SkippedFrames:	return "frames_skipped";
+		case Counter::DroppedFrames:	return "frames_dropped";
+		default:						return "unknown";
+		}
+	}
+
+	const char * Metrics::GetName(Histogram histogram)
+	{
+		switch(histogram)
+		{
+		case Histogram::InstructionsPerFrame:	return "instructions_per_frame";
+		case Histogram::ExecNs:					return "exec_ns";
+		case Histogram::RenderNs:				return "render_ns";
+		case Histogram::SleepNs:				return "sleep_ns";
+		case Histogram::AudioCallbackNs:		return "audio_callback_ns";
+		default:								return "unknown";
+		}
+	}
+
+	std::string Metrics::ToJson(const Snapshot &snapshot)
+	{
+		std::stringstream ss;
+		ss << "{\n\t\"counters\": {";
+		for(uint i = 0; i < CounterCount; ++i)
+			ss << (i? ",": "") << "\n\t\t\"" << GetName(static_cast<Counter>(i)) << "\": " << snapshot.Counters[i];
+		ss << "\n\t},\n\t\"histograms\": {";
+		for(uint i = 0; i < HistogramCount; ++i)
+		{
+			auto &histogram = snapshot.Histograms[i];
+			ss << (i? ",": "") << "\n\t\t\"" << GetName(static_cast<Histogram>(i)) << "\": { \"count\": " << histogram.Count
+				<< ", \"sum\": " << histogram.Sum << ", \"buckets\": [";
+			for(uint b = 0; b < BucketCount; ++b)
+				ss << (b? ", ": "") << histogram.Buckets[b];
+			ss << "] }";
+		}
+		ss << "\n\t}\n}\n";
+		return ss.str();
+	}
+
+	std::string Metrics::ToPrometheus(const Snapshot &snapshot)
+	{
+		std::stringstream ss;
+		for(uint i = 0; i < CounterCount; ++i)
+		{
+			auto name = GetName(static_cast<Counter>(i));
+			ss << "# TYPE xomod_" << name << "_total counter\n";
+			ss << "xomod_" << name << "_total " << snapshot.Counters[i] << "\n";
+		}
+		for(uint i = 0; i < HistogramCount; ++i)
+		{
+			auto name = GetName(static_cast<Histogram>(i));
+			auto &histogram = snapshot.Histograms[i];
+			ss << "# TYPE xomod_" << name << " histogram\n";
+			u64 total = 0;
+			for(uint b = 0; b + 1 < BucketCount; ++b)
+			{
+				total += histogram.Buckets[b];
+				ss << "xomod_" << name << "_bucket{le=\"" << ((1ull << b) - 1) << "\"} " << total << "\n";
+			}
+			ss << "xomod_" << name << "_bucket{le=\"+Inf\"} " << histogram.Count << "\n";
+			ss << "xomod_" << name << "_sum " << histogram.Sum << "\n";
+			ss << "xomod_" << name << "_count " << histogram.Count << "\n";
+		}
+		return ss.str();
+	}
+
+	MetricsWriter::MetricsWriter(const std::string &path, uint intervalMs):
+		_path(path), _intervalMs(intervalMs), _stop(false)
+	{ _thread = std::thread([this]() { Run(); }); }
+
+	MetricsWriter::~MetricsWriter()
+	{
+		{
+			std::lock_guard<std::mutex> l(_lock);
+			_stop = true;
+		}
+		_changed.notify_one();
+		_thread.join();
+		Write();
+	}
+
+	void MetricsWriter::Run()
+	{
+		std::unique_lock<std::mutex> l(_lock);
+		while(!_changed.wait_for(l, std::chrono::milliseconds(_intervalMs), [this]() { return _stop; }))
+		{
+			l.unlock();
+			Write();
+			l.lock();
+		}
+	}
+
+	void MetricsWriter::Write()
+	{
+		auto snapshot = Metrics::Collect();
+		auto text = EndsWith(_path, ".json")? Metrics::ToJson(snapshot): Metrics::ToPrometheus(snapshot);
+		try
+		{
+			//scrapers never see a partial file
+			auto temp = _path + ".tmp";
+			{
+				File file(temp, "wb");
+				file.Write(text.data(), text.size());
+			}
+			if (rename(temp.c_str(), _path.c_str()) != 0)
+				perror(("rename " + temp).c_str());
+		}
+		catch(const std::exception &ex)
+		{ fprintf(stderr, "could not write metrics %s: %s\n", _path.c_str(), ex.what()); }
+	}
+}
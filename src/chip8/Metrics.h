@@ -0,0 +1,120 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chip8/types.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace chip8
+{
+	///process-wide counters and log2 histograms, always on
+	///every thread updates its own shard with relaxed load/store pairs, Collect sums all shards
+	class Metrics
+	{
+	public:
+		enum class Counter
+		{
+			Frames, Instructions, Sprites, Collisions, Scrolls, AudioCallbacks,
+			RenderedFrames, ElidedFrames, SkippedFrames, DroppedFrames,
+			Count
+		};
+
+		enum class Histogram
+		{
+			InstructionsPerFrame, ExecNs, RenderNs, SleepNs, AudioCallbackNs,
+			Count
+		};
+
+		static constexpr uint CounterCount	= static_cast<uint>(Counter::Count);
+		static constexpr uint HistogramCount	= static_cast<uint>(Histogram::Count);
+		static constexpr uint BucketCount		= 40; //bucket n holds values below 2^n
+
+		struct HistogramData
+		{
+			u64							Count;
+			u64							Sum;
+			std::array<u64, BucketCount>	Buckets;
+		};
+
+		struct Snapshot
+		{
+			std::array<u64, CounterCount>				Counters;
+			std::array<HistogramData, HistogramCount>	Histograms;
+		};
+
+	private:
+		using Value = std::atomic<u64>;
+
+		struct Shard
+		{
+			std::array<Value, CounterCount>						Counters;
+			std::array<Value, HistogramCount>					Counts, Sums;
+			std::array<std::array<Value, BucketCount>, HistogramCount>	Buckets;
+
+			Shard();
+		};
+
+		static Shard * Register();
+
+		static Shard & GetShard()
+		{
+			thread_local Shard *shard = Register(); //shards outlive threads, their counts stay in totals
+			return *shard;
+		}
+
+		///only the owning thread writes, no locked instruction needed
+		static void Increment(Value &value, u64 n)
+		{ value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+
+	public:
+		static void Add(Counter counter, u64 n = 1)
+		{ Increment(GetShard().Counters[static_cast<uint>(counter)], n); }
+
+		static void Record(Histogram histogram, u64 value)
+		{
+			auto &shard = GetShard();
+			uint index = static_cast<uint>(histogram);
+			uint bucket = value? 64 - __builtin_clzll(value): 0;
+			Increment(shard.Counts[index], 1);
+			Increment(shard.Sums[index], value);
+			Increment(shard.Buckets[index][bucket < BucketCount? bucket: BucketCount - 1], 1);
+		}
+
+		static Snapshot Collect();
+
+		static const char * GetName(Counter counter);
+		static const char * GetName(Histogram histogram);
+
+		static std::string ToJson(const Snapshot &snapshot);
+		///Prometheus text exposition format, histograms with cumulative power of two buckets
+		static std::string ToPrometheus(const Snapshot &snapshot);
+	};
+
+	///rewrites metrics file every interval on background thread and once more on destruction
+	///paths ending in .json get JSON, anything else Prometheus text
+	class MetricsWriter
+	{
+		std::string					_path;
+		uint						_intervalMs;
+		std::mutex					_lock;
+		std::condition_variable		_changed;
+		bool						_stop;
+		std::thread					_thread;
+
+		void Run();
+		void Write();
+
+	public:
+		MetricsWriter(const std::string &path, uint intervalMs = 1000);
+		~MetricsWriter();
+
+		MetricsWriter(const MetricsWriter &) = delete;
+		MetricsWriter& operator = (const MetricsWriter &) = delete;
+	};
+}
+
+#endif
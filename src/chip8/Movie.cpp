@@ -0,0 +1,83 @@
+#include <chip8/Movie.h>
+#include <chip8/File.h>
+#include <string.h>
+
+namespace chip8
+{
+	namespace
+	{
+		const char Magic[4] = { 'X', 'O', 'M', 'V' };
+
+		//file layout, all values are little-endian:
+		//magic[4] version[1] reserved[3] seed[4] frames[4] runs[4]
+		//followed by runs of mask[2] count[2]
+		static constexpr size_t HeaderSize = 20;
+
+		void Write16(u8 *dst, u16 value)
+		{ dst[0] = value; dst[1] = value >> 8; }
+
+		void Write32(u8 *dst, u32 value)
+		{ Write16(dst, value); Write16(dst + 2, value >> 16); }
+
+		u16 Read16(const u8 *src)
+		{ return src[0] | (static_cast<u16>(src[1]) << 8); }
+
+		u32 Read32(const u8 *src)
+		{ return Read16(src) | (static_cast<u32>(Read16(src + 2)) << 16); }
+	}
+
+	void Movie::Load(const std::string &path)
+	{
+		File file(path, "rb");
+		auto data = file.ReadAll<std::vector<u8>>();
+		if (data.size() < HeaderSize || memcmp(data.data(), Magic, sizeof(Magic)) != 0)
+			throw std::runtime_error("invalid movie file " + path);
+		if (data[4] != Version)
+			throw std::runtime_error("unsupported movie version in " + path);
+
+		_seed = Read32(data.data() + 8);
+		u32 frames = Read32(data.data() + 12);
+		u32 runs = Read32(data.data() + 16);
+		size_t payload = data.size() - HeaderSize; //in size_t, runs * 4 wraps in u32
+		if (payload % 4 != 0 || payload / 4 != runs)
+			throw std::runtime_error("truncated movie file " + path);
+		if (frames > static_cast<size_t>(runs) * 0xffff) //checked before reserve
+			throw std::runtime_error("corrupted movie file " + path);
+
+		_frames.clear();
+		_frames.reserve(frames);
+		for(const u8 *run = data.data() + HeaderSize; runs--; run += 4)
+			_frames.insert(_frames.end(), Read16(run + 2), Read16(run));
+
+		if (_frames.size() != frames)
+			throw std::runtime_error("corrupted movie file " + path);
+	}
+
+	void Movie::Save(const std::string &path) const
+	{
+		std::vector<u8> data(HeaderSize);
+		for(size_t frame = 0; frame < _frames.size(); )
+		{
+			u16 keys = _frames[frame];
+			size_t count = 1;
+			while(frame + count < _frames.size() && _frames[frame + count] == keys && count < 0xffff)
+				++count;
+			frame += count;
+
+			u8 run[4];
+			Write16(run, keys);
+			Write16(run + 2, count);
+			data.insert(data.end(), run, run + sizeof(run));
+		}
+
+		std::copy(Magic, Magic + sizeof(Magic), data.begin());
+		data[4] = Version;
+		Write32(data.data() + 8, _seed);
+		Write32(data.data() + 12, _frames.size());
+		Write32(data.data() + 16, (data.size() - HeaderSize) / 4);
+
+		File file(path, "wb");
+		if (file.Write(data.data(), data.size()) != data.size())
+			throw std::runtime_error("could not write movie file " + path);
+	}
+}
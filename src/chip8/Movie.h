@@ -0,0 +1,41 @@
+#ifndef MOVIE_H
+#define MOVIE_H
+
+#include <chip8/types.h>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///input movie: random seed and per-frame 16-bit key mask
+	class Movie
+	{
+		static constexpr u8 Version = 1;
+
+		u32					_seed;
+		std::vector<u16>	_frames;
+
+	public:
+		Movie(u32 seed = 0): _seed(seed) { }
+
+		u32 GetSeed() const
+		{ return _seed; }
+
+		void SetSeed(u32 seed)
+		{ _seed = seed; }
+
+		size_t GetSize() const
+		{ return _frames.size(); }
+
+		u16 Get(size_t frame) const
+		{ return frame < _frames.size()? _frames[frame]: 0; }
+
+		void Append(u16 keys)
+		{ _frames.push_back(keys); }
+
+		void Load(const std::string &path);
+		void Save(const std::string &path) const;
+	};
+}
+
+#endif
@@ -0,0 +1,276 @@
+#include <chip8/Netplay.h>
+#include <chip8/Chip8.h>
+#include <chip8/State.h>
+#include <chip8/Timeline.h>
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	namespace
+	{
+		const u8 Magic[4] = { 'X', 'O', 'N', 'P' };
+		static constexpr u8 ProtocolVersion = 1;
+		static constexpr size_t HelloSize = 8 + 4 + 1;
+		static constexpr size_t InputSize = 4 + 4 + 1; //without key masks
+
+		enum class Packet : u8
+		{
+			Hello	= 1,	//rom hash, seed, ready flag
+			Input	= 2,	//ack, first frame, count, key masks
+		};
+
+		u64 Now()
+		{
+			using namespace std::chrono;
+			return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+		}
+
+		void SplitAddress(const std::string &address, std::string &host, std::string &port)
+		{
+			auto colon = address.rfind(':');
+			host = colon != address.npos? address.substr(0, colon): std::string();
+			port = colon != address.npos? address.substr(colon + 1): address;
+		}
+
+		addrinfo *Resolve(const std::string &address, int family, bool passive)
+		{
+			std::string host, port;
+			SplitAddress(address, host, port);
+			addrinfo hints = {};
+			hints.ai_family = family;
+			hints.ai_socktype = SOCK_DGRAM;
+			hints.ai_flags = passive? AI_PASSIVE: 0;
+			addrinfo *result;
+			if (int error = getaddrinfo(host.empty()? nullptr: host.c_str(), port.c_str(), &hints, &result))
+				throw std::runtime_error("could not resolve " + address + ": " + gai_strerror(error));
+			return result;
+		}
+	}
+
+	Netplay::Netplay(Chip8 &chip, NetplayBackend &backend, const std::string &local, const std::string &peer):
+		_chip(chip), _backend(backend), _socket(-1), _romHash(0), _seed(0),
+		_started(false), _peerHello(false), _peerReady(false), _peerSeed(0),
+		_frame(0), _remoteConfirmed(0), _peerAck(0), _rollbackFrom(~0u), _lastRemote(0), _lastReceived(0),
+		_local(), _remote(), _predicted(), _stats()
+	{
+		addrinfo *peerInfo = Resolve(peer, AF_UNSPEC, false);
+		addrinfo *localInfo = nullptr;
+		try
+		{
+			localInfo = Resolve(local, peerInfo->ai_family, true);
+			_socket = socket(peerInfo->ai_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+			if (_socket < 0)
+				throw std::runtime_error(std::string("socket: ") + strerror(errno));
+			if (bind(_socket, localInfo->ai_addr, localInfo->ai_addrlen) != 0)
+				throw std::runtime_error("could not bind " + local + ": " + strerror(errno));
+			//connected socket drops datagrams from anyone else
+			if (connect(_socket, peerInfo->ai_addr, peerInfo->ai_addrlen) != 0)
+				throw std::runtime_error("could not connect to " + peer + ": " + strerror(errno));
+		}
+		catch(...)
+		{
+			if (_socket >= 0)
+				close(_socket);
+			if (localInfo)
+				freeaddrinfo(localInfo);
+			freeaddrinfo(peerInfo);
+			throw;
+		}
+		freeaddrinfo(localInfo);
+		freeaddrinfo(peerInfo);
+	}
+
+	Netplay::~Netplay()
+	{ close(_socket); }
+
+	void Netplay::Send(const std::vector<u8> &packet)
+	{
+		//lost datagrams are covered by resending, refused ones mean peer is not up yet
+		if (send(_socket, packet.data(), packet.size(), 0) < 0)
+			{ }
+	}
+
+	void Netplay::SendHello()
+	{
+		std::vector<u8> packet;
+		StateWriter writer(packet);
+		writer.Write(Magic, sizeof(Magic));
+		writer.Write8(ProtocolVersion);
+		writer.Write8(static_cast<u8>(Packet::Hello));
+		writer.Write64(_romHash);
+		writer.Write32(_seed);
+		writer.Write8(_peerHello? 1: 0);
+		Send(packet);
+	}
+
+	void Netplay::SendInput(u32 end)
+	{
+		u32 first = std::max(_peerAck, end > MaxInputs? end - MaxInputs: 0u);
+		std::vector<u8> packet;
+		StateWriter writer(packet);
+		writer.Write(Magic, sizeof(Magic));
+		writer.Write8(ProtocolVersion);
+		writer.Write8(static_cast<u8>(Packet::Input));
+		writer.Write32(_remoteConfirmed);
+		writer.Write32(first);
+		writer.Write8(end > first? end - first: 0);
+		for(u32 frame = first; frame < end; ++frame)
+			writer.Write16(_local[frame % History]);
+		Send(packet);
+	}
+
+	void Netplay::Poll()
+	{
+		u8 buffer[512];
+		while(true)
+		{
+			ssize_t size = recv(_socket, buffer, sizeof(buffer), 0);
+			if (size < 0)
+			{
+				if (errno == EINTR || errno == ECONNREFUSED)
+					continue;
+				break;
+			}
+			if (size < static_cast<ssize_t>(sizeof(Magic)) + 2 || memcmp(buffer, Magic, sizeof(Magic)) != 0 || buffer[sizeof(Magic)] != ProtocolVersion)
+				continue;
+
+			const u8 *payload = buffer + sizeof(Magic) + 2;
+			size_t payloadSize = size - sizeof(Magic) - 2;
+			switch(static_cast<Packet>(buffer[sizeof(Magic) + 1]))
+			{
+			case Packet::Hello:
+				if (payloadSize < HelloSize)
+					continue;
+				OnHello(payload, payloadSize);
+				break;
+			case Packet::Input:
+				if (payloadSize < InputSize || payloadSize < InputSize + 2u * payload[InputSize - 1])
+					continue;
+				OnInput(payload, payloadSize);
+				break;
+			default:
+				continue;
+			}
+			_lastReceived = Now();
+		}
+	}
+
+	void Netplay::OnHello(const u8 *data, size_t size)
+	{
+		StateReader reader(data, size);
+		u64 romHash = reader.Read64();
+		u32 seed = reader.Read32();
+		bool ready = reader.Read8();
+		if (romHash != _romHash)
+			throw std::runtime_error("netplay peer runs a different rom");
+		_peerHello = true;
+		_peerSeed = seed;
+		_peerReady |= ready;
+		if (_started) //our ready hello was lost
+			SendHello();
+	}
+
+	void Netplay::OnInput(const u8 *data, size_t size)
+	{
+		StateReader reader(data, size);
+		u32 ack = reader.Read32();
+		u32 first = reader.Read32();
+		u8 count = reader.Read8();
+
+		//peer simulates only after seeing our hello
+		_peerReady = true;
+		_peerAck = std::max(_peerAck, std::min(ack, _frame));
+
+		for(u32 frame = first; frame < first + count; ++frame)
+		{
+			u16 keys = reader.Read16();
+			if (frame < _remoteConfirmed)
+				continue;
+			if (frame > _remoteConfirmed || frame >= _frame + MaxRollback)
+				break; //gap from reordering, peer resends
+
+			auto index = frame % History;
+			_remote[index] = keys;
+			if (frame < _frame && _predicted[index] != keys)
+				_rollbackFrom = std::min(_rollbackFrom, frame);
+			_lastRemote = keys;
+			++_remoteConfirmed;
+		}
+	}
+
+	void Netplay::Connect(u64 romHash, u32 seed)
+	{
+		_romHash = romHash;
+		_seed = seed;
+
+		while(!_peerHello || !_peerReady)
+		{
+			SendHello();
+			pollfd pfd = { _socket, POLLIN, 0 };
+			::poll(&pfd, 1, 100);
+			Poll();
+		}
+		_started = true;
+		SendHello();
+
+		_seed = std::min(seed, _peerSeed);
+		_chip.Seed(_seed);
+		_lastReceived = Now();
+	}
+
+	bool Netplay::Simulate(u32 frame)
+	{
+		auto index = frame % History;
+		u16 remote;
+		if (frame < _remoteConfirmed)
+			remote = _remote[index]; //never rolled back past, no snapshot needed
+		else
+		{
+			auto &snapshot = _snapshots[index];
+			snapshot.clear();
+			_chip.SaveState(snapshot);
+			remote = _lastRemote;
+		}
+		_predicted[index] = remote;
+		_backend.SetKeys(_local[index] | remote);
+		return _chip.AdvanceFrame();
+	}
+
+	bool Netplay::Step()
+	{
+		Poll();
+		if (Now() - _lastReceived > TimeoutMs)
+			throw std::runtime_error("netplay peer timed out");
+
+		if (_frame >= _remoteConfirmed + MaxRollback)
+		{
+			++_stats.Stalls;
+			SendInput(_frame);
+			return _chip.IsRunning();
+		}
+
+		_local[_frame % History] = _backend.GetLocalKeys();
+		SendInput(_frame + 1);
+
+		if (_rollbackFrom < _frame)
+		{
+			Timeline::Zone zone("Rollback");
+			auto &snapshot = _snapshots[_rollbackFrom % History];
+			_chip.LoadState(snapshot.data(), snapshot.size());
+			++_stats.Rollbacks;
+			for(u32 frame = _rollbackFrom; frame < _frame; ++frame, ++_stats.Resimulated)
+				Simulate(frame);
+		}
+		_rollbackFrom = ~0u;
+
+		return Simulate(_frame++);
+	}
+}
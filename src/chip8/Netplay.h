@@ -0,0 +1,112 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <chip8/backend/ProxyBackend.h>
+#include <chip8/types.h>
+#include <array>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	class Chip8;
+
+	///feeds combined key mask of both peers to the machine, local keys come from wrapped backend
+	class NetplayBackend : public ProxyBackend
+	{
+		u16		_keys;
+
+	public:
+		NetplayBackend(Backend & backend): ProxyBackend(backend), _keys(0) { }
+
+		void SetKeys(u16 keys)
+		{ _keys = keys; }
+
+		u16 GetLocalKeys()
+		{
+			u16 keys = 0;
+			for(u8 i = 0; i < 16; ++i)
+				keys |= _backend.GetKeyState(i)? 1 << i: 0;
+			return keys;
+		}
+
+		bool GetKeyState(u8 index) override
+		{ return index < 16 && (_keys & (1 << index)); }
+	};
+
+	///two-player rollback netplay over UDP: local input is applied immediately, remote input is predicted
+	///as its last known value; when real remote input differs, the machine is restored from the snapshot
+	///taken before that frame and re-simulated without rendering
+	class Netplay
+	{
+		static constexpr uint History		= 32;	//ring size for inputs and snapshots
+		static constexpr uint MaxRollback	= 12;	//frames ahead of confirmed remote input before stalling
+		static constexpr uint MaxInputs		= 24;	//inputs resent per packet
+		static constexpr uint TimeoutMs		= 10000;
+
+	public:
+		struct Stats
+		{
+			uint	Rollbacks;
+			uint	Resimulated;	//frames simulated again after misprediction
+			uint	Stalls;			//frames waited for remote input
+		};
+
+	private:
+		Chip8 &				_chip;
+		NetplayBackend &	_backend;
+		int					_socket;
+		u64					_romHash;
+		u32					_seed;
+
+		bool				_started;
+		bool				_peerHello;
+		bool				_peerReady;			//peer has our hello
+		u32					_peerSeed;
+
+		u32					_frame;				//next frame to simulate
+		u32					_remoteConfirmed;	//remote inputs before this frame are known
+		u32					_peerAck;			//peer has our inputs before this frame
+		u32					_rollbackFrom;
+		u16					_lastRemote;
+		u64					_lastReceived;		//ms, for timeout
+
+		std::array<u16, History>				_local, _remote, _predicted;
+		std::array<std::vector<u8>, History>	_snapshots;
+
+		Stats				_stats;
+
+		void Send(const std::vector<u8> &packet);
+		void SendHello();
+		///sends local inputs peer has not acknowledged, up to frame end
+		void SendInput(u32 end);
+		///handles all pending packets without blocking
+		void Poll();
+		void OnHello(const u8 *data, size_t size);
+		void OnInput(const u8 *data, size_t size);
+		bool Simulate(u32 frame);
+
+	public:
+		///binds local [host:]port and exchanges packets only with peer host:port
+		Netplay(Chip8 &chip, NetplayBackend &backend, const std::string &local, const std::string &peer);
+		~Netplay();
+
+		Netplay(const Netplay &) = delete;
+		Netplay& operator = (const Netplay &) = delete;
+
+		///waits for peer with the same rom, both machines are seeded with the smaller of the two seeds
+		void Connect(u64 romHash, u32 seed);
+
+		///advances one frame, re-simulating mispredicted frames first; returns false once machine has halted
+		///if remote input is too far behind, the frame is skipped and the machine stays where it was
+		bool Step();
+
+		u32 GetFrame() const
+		{ return _frame; }
+
+		const Stats & GetStats() const
+		{ return _stats; }
+	};
+}
+
+#endif
@@ -0,0 +1,143 @@
+#include <chip8/Profiler.h>
+#include <chip8/File.h>
+#include <chip8/String.h>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace chip8
+{
+	namespace
+	{
+		static constexpr size_t TopAddresses = 64;
+
+		void WriteFile(const std::string &path, const std::string &text)
+		{
+			File file(path, "wt");
+			file.Write(text.data(), text.size());
+		}
+
+		template<typename Key>
+		std::vector<std::pair<Key, u64>> SortByCount(std::vector<std::pair<Key, u64>> counts)
+		{
+			std::stable_sort(counts.begin(), counts.end(), [](const std::pair<Key, u64> &a, const std::pair<Key, u64> &b) -> bool {
+				return a.second > b.second;
+			});
+			return counts;
+		}
+	}
+
+	Profiler::Profiler():
+		_ops(0x10000), _pcs(0x10000),
+		_nodes(1, Node { 0, 0, 0, {} }), _current(0), _total(0),
+		_sprites(0), _spriteNs(0), _scrolls(0), _scrollNs(0)
+	{ }
+
+	void Profiler::OnCall(u16 addr)
+	{
+		auto & children = _nodes[_current].Children;
+		auto it = children.find(addr);
+		if (it != children.end())
+		{
+			_current = it->second;
+			return;
+		}
+		u32 child = _nodes.size();
+		children[addr] = child;
+		_nodes.push_back(Node { addr, _current, 0, {} });
+		_current = child;
+	}
+
+	std::string Profiler::GetOpcodeClass(u16 op)
+	{
+		u8 group = op >> 12;
+		std::string hex = ToHex(op);
+		switch(group)
+		{
+		case 0x0:
+			switch(op & 0xfff0)
+			{
+			case 0x00c0:
+			case 0x00d0:
+				return hex.substr(0, 3) + "N";
+			default:
+				return hex;
+			}
+		case 0x1: case 0x2: case 0xa: case 0xb:
+			return hex.substr(0, 1) + "NNN";
+		case 0x3: case 0x4: case 0x6: case 0x7: case 0xc:
+			return hex.substr(0, 1) + "XNN";
+		case 0x5: case 0x8: case 0x9:
+			return hex.substr(0, 1) + "XY" + hex.substr(3);
+		case 0xd:
+			return "DXYN";
+		default: //0xe, 0xf
+			return op == 0xf000? hex: hex.substr(0, 1) + "X" + hex.substr(2);
+		}
+	}
+
+	std::string Profiler::GetReport() const
+	{
+		std::map<std::string, u64> classes;
+		for(uint op = 0; op < _ops.size(); ++op)
+			if (_ops[op])
+				classes[GetOpcodeClass(op)] += _ops[op];
+
+		std::vector<std::pair<u16, u64>> pcs;
+		for(uint pc = 0; pc < _pcs.size(); ++pc)
+			if (_pcs[pc])
+				pcs.emplace_back(pc, _pcs[pc]);
+
+		auto percent = [this](u64 n) { return _total? 100.0 * n / _total: 0.0; };
+
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(2);
+		ss << "instructions: " << _total << "\n\n";
+
+		ss << "opcode class:\n";
+		for(auto & entry : SortByCount(std::vector<std::pair<std::string, u64>>(classes.begin(), classes.end())))
+			ss << "  " << entry.first << " " << std::setw(14) << entry.second << " " << std::setw(6) << percent(entry.second) << "%\n";
+
+		ss << "\nhot addresses:\n";
+		auto sortedPcs = SortByCount(pcs);
+		if (sortedPcs.size() > TopAddresses)
+			sortedPcs.resize(TopAddresses);
+		for(auto & entry : sortedPcs)
+			ss << "  0x" << ToHex(entry.first) << " " << std::setw(14) << entry.second << " " << std::setw(6) << percent(entry.second) << "%\n";
+
+		ss << "\nsprites: " << _sprites << ", " << _spriteNs / 1000 << " us";
+		if (_sprites)
+			ss << ", " << _spriteNs / _sprites << " ns/sprite";
+		ss << "\nscrolls: " << _scrolls << ", " << _scrollNs / 1000 << " us";
+		if (_scrolls)
+			ss << ", " << _scrollNs / _scrolls << " ns/scroll";
+		ss << "\n";
+		return ss.str();
+	}
+
+	std::string Profiler::GetFoldedStacks() const
+	{
+		std::stringstream ss;
+		for(auto & node : _nodes)
+		{
+			if (!node.Samples)
+				continue;
+
+			std::vector<u16> chain;
+			for(auto *n = &node; n != &_nodes[0]; n = &_nodes[n->Parent])
+				chain.push_back(n->Addr);
+
+			ss << "main";
+			for(auto it = chain.rbegin(); it != chain.rend(); ++it)
+				ss << ";sub_0x" << ToHex(*it);
+			ss << " " << node.Samples << "\n";
+		}
+		return ss.str();
+	}
+
+	void Profiler::Save(const std::string &prefix) const
+	{
+		WriteFile(prefix + ".txt", GetReport());
+		WriteFile(prefix + ".folded", GetFoldedStacks());
+	}
+}
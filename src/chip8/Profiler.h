@@ -0,0 +1,58 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chip8/types.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///counts executed instructions per opcode, per guest pc and per call chain
+	class Profiler
+	{
+		struct Node
+		{
+			u16						Addr;
+			u32						Parent;
+			u64						Samples;
+			std::map<u16, u32>		Children;
+		};
+
+		std::vector<u64>	_ops;
+		std::vector<u64>	_pcs;
+		std::vector<Node>	_nodes;
+		u32					_current;
+		u64					_total;
+
+		u64					_sprites, _spriteNs;
+		u64					_scrolls, _scrollNs;
+
+	public:
+		Profiler();
+
+		void OnStep(u16 pc, u16 op)
+		{ ++_ops[op]; ++_pcs[pc]; ++_nodes[_current].Samples; ++_total; }
+
+		void OnCall(u16 addr);
+		void OnReturn()
+		{ if (_current) _current = _nodes[_current].Parent; }
+
+		void OnSprite(u64 ns)
+		{ ++_sprites; _spriteNs += ns; }
+
+		void OnScroll(u64 ns)
+		{ ++_scrolls; _scrollNs += ns; }
+
+		static std::string GetOpcodeClass(u16 op);
+
+		///writes <prefix>.txt report and <prefix>.folded stacks for flamegraph.pl
+		void Save(const std::string &prefix) const;
+
+	private:
+		std::string GetReport() const;
+		std::string GetFoldedStacks() const;
+	};
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include <chip8/Rom.h>
+#include <chip8/Assembler.h>
+#include <chip8/Config.h>
+#include <chip8/File.h>
+#include <chip8/Hash.h>
+#include <chip8/MappedFile.h>
+#include <chip8/String.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	namespace
+	{
+		bool IsSource(const std::string &path)
+		{
+			auto dot = path.rfind('.');
+			if (dot == path.npos)
+				return false;
+			auto ext = path.substr(dot);
+			return ext == ".8o" || ext == ".o8";
+		}
+	}
+
+	std::vector<u8> LoadRom(const std::string &path)
+	{
+		MappedFile file(path);
+		auto data = file.GetData();
+		if (!IsSource(path))
+			return std::vector<u8>(data, data + file.GetSize());
+
+		std::string_view source(reinterpret_cast<const char *>(data), file.GetSize());
+		u64 hash = Hash(source.data(), source.size());
+		uint version = Assembler::Version;
+		hash = Hash(&version, sizeof(version), hash);
+
+		auto cacheDir = Config::GetConfigPath() + "/cache";
+		auto cacheFile = cacheDir + "/" + ToHex(hash) + ".ch8";
+		if (File::Exists(cacheFile))
+		{
+			MappedFile cached(cacheFile);
+			return std::vector<u8>(cached.GetData(), cached.GetData() + cached.GetSize());
+		}
+
+		auto rom = Assembler::Assemble(std::string(source), path);
+
+		//write under temporary name, concurrent instances never see partial file
+		mkdir(cacheDir.c_str(), 0770);
+		auto tempFile = cacheFile + "." + std::to_string(getpid());
+		{
+			File cached(tempFile, "wb");
+			if (cached.Write(rom.data(), rom.size()) != rom.size())
+				throw std::runtime_error("could not write " + tempFile);
+		}
+		if (rename(tempFile.c_str(), cacheFile.c_str()) != 0)
+			throw std::runtime_error("could not rename " + tempFile);
+		return rom;
+	}
+}
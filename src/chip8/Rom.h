@@ -0,0 +1,15 @@
+#ifndef ROM_H
+#define ROM_H
+
+#include <chip8/types.h>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///returns rom image from binary file or Octo source (.8o/.o8)
+	///sources are assembled once and cached by content hash in Config::GetConfigPath()/cache
+	std::vector<u8> LoadRom(const std::string &path);
+}
+
+#endif
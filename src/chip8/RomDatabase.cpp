@@ -0,0 +1,94 @@
+#include <chip8/RomDatabase.h>
+#include <chip8/File.h>
+#include <chip8/Hash.h>
+#include <algorithm>
+#include <string.h>
+
+namespace chip8
+{
+	namespace
+	{
+		const char Magic[4] = { 'X', 'O', 'D', 'B' };
+	}
+
+	RomDatabase::RomDatabase(const std::string &path): _file(path), _records(nullptr), _count(0)
+	{
+		if (_file.GetSize() < sizeof(Header))
+			throw std::runtime_error("truncated rom database " + path);
+		auto header = reinterpret_cast<const Header *>(_file.GetData());
+		if (memcmp(header->Magic, Magic, sizeof(Magic)) != 0 || header->Version != Version)
+			throw std::runtime_error("invalid rom database " + path);
+		if (header->Count > (_file.GetSize() - sizeof(Header)) / sizeof(Record))
+			throw std::runtime_error("truncated rom database " + path);
+		_records = reinterpret_cast<const Record *>(_file.GetData() + sizeof(Header));
+		_count = header->Count;
+	}
+
+	const RomDatabase::Record *RomDatabase::Find(u64 hash) const
+	{
+		auto end = _records + _count;
+		auto record = std::lower_bound(_records, end, hash, [](const Record &r, u64 h) { return r.Hash < h; });
+		return record != end && record->Hash == hash? record: nullptr;
+	}
+
+	u64 RomDatabase::HashRom(const u8 *data, size_t size)
+	{ return Hash(data, size); }
+
+	RomDatabase::Record RomDatabase::MakeRecord(u64 hash, const Config &config)
+	{
+		Record record = {};
+		record.Hash			= hash;
+		record.Speed		= config.Core.Speed;
+		record.DelayLoop	= config.Core.DelayLoop;
+
+		auto &q = config.Quirks;
+		record.Quirks = (q.Shift? 1: 0) | (q.LoadStore? 2: 0) | (q.VFOrder? 4: 0) | (q.Clip? 8: 0) | (q.Jump? 16: 0);
+
+		auto &p = config.Palette;
+		const Config::Color palette[] = { p.BG, p.C1, p.C2, p.BL, p.Buzz, p.Border };
+		std::copy(std::begin(palette), std::end(palette), record.Palette);
+		return record;
+	}
+
+	void RomDatabase::Apply(const Record &record, Config &config)
+	{
+		config.Core.Speed		= record.Speed;
+		config.Core.DelayLoop	= record.DelayLoop;
+
+		auto &q = config.Quirks;
+		q.Shift		= record.Quirks & 1;
+		q.LoadStore	= record.Quirks & 2;
+		q.VFOrder	= record.Quirks & 4;
+		q.Clip		= record.Quirks & 8;
+		q.Jump		= record.Quirks & 16;
+
+		auto &p = config.Palette;
+		p.BG		= record.Palette[0];
+		p.C1		= record.Palette[1];
+		p.C2		= record.Palette[2];
+		p.BL		= record.Palette[3];
+		p.Buzz		= record.Palette[4];
+		p.Border	= record.Palette[5];
+	}
+
+	void RomDatabase::Save(const std::string &path, std::vector<Record> records)
+	{
+		std::sort(records.begin(), records.end(), [](const Record &a, const Record &b) { return a.Hash < b.Hash; });
+		auto duplicate = std::adjacent_find(records.begin(), records.end(), [](const Record &a, const Record &b) { return a.Hash == b.Hash; });
+		if (duplicate != records.end())
+			throw std::runtime_error("duplicate rom hash in database");
+
+		Header header = {};
+		memcpy(header.Magic, Magic, sizeof(Magic));
+		header.Version	= Version;
+		header.Count	= records.size();
+
+		File file(path, "wb");
+		file.Write(&header, sizeof(header));
+		if (file.Write(records.data(), records.size() * sizeof(Record)) != records.size() * sizeof(Record))
+			throw std::runtime_error("could not write rom database " + path);
+	}
+
+	std::string RomDatabase::GetDefaultPath()
+	{ return Config::GetConfigPath() + "/romdb.bin"; }
+}
@@ -0,0 +1,67 @@
+#ifndef ROMDATABASE_H
+#define ROMDATABASE_H
+
+#include <chip8/Config.h>
+#include <chip8/MappedFile.h>
+#include <chip8/types.h>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///per-rom core, quirks and palette settings keyed by rom content hash
+	///file is a header followed by records sorted by hash in native byte order, built by xomod-romdb
+	class RomDatabase
+	{
+	public:
+		struct Record
+		{
+			u64				Hash;
+			u32				Speed;
+			u16				DelayLoop;
+			u8				Quirks;		//bit per QuirksConfig field in declaration order
+			u8				Reserved;
+			Config::Color	Palette[6];	//bg, color1, color2, blend, buzzer, border
+			u8				Padding[6];
+		};
+		static_assert(sizeof(Record) == 40, "database record layout changed");
+
+		struct Header
+		{
+			char			Magic[4];
+			u32				Version;
+			u64				Count;
+		};
+
+		static constexpr u32 Version = 1;
+
+	private:
+		MappedFile			_file;
+		const Record *		_records;
+		size_t				_count;
+
+	public:
+		///maps database, throws on missing file or bad header
+		RomDatabase(const std::string &path);
+
+		size_t GetSize() const
+		{ return _count; }
+
+		///binary search, null if rom is unknown
+		const Record *Find(u64 hash) const;
+
+		///hash used as database key
+		static u64 HashRom(const u8 *data, size_t size);
+
+		static Record MakeRecord(u64 hash, const Config &config);
+		static void Apply(const Record &record, Config &config);
+
+		///sorts records and writes database file
+		static void Save(const std::string &path, std::vector<Record> records);
+
+		///default location, ~/.local/share/xomod/romdb.bin
+		static std::string GetDefaultPath();
+	};
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include <chip8/SpeedTuner.h>
+#include <algorithm>
+
+namespace chip8
+{
+	void SpeedTuner::Reset()
+	{
+		_speed = 0;
+		_loops.fill(NoAddr);
+		_waitingAt = NoAddr;
+		_readAddr = NoAddr;
+		_readValue = 0;
+		_late = false;
+		_frames = _idleFrames = _busyFrames = _lateFrames = 0;
+		_peak = 0;
+		_required = 0;
+		_lateWindows = _busyWindows = 0;
+	}
+
+	bool SpeedTuner::IsConfident(uint configured) const
+	{
+		if (!IsTuned())
+			return false;
+		uint evidence = _lateWindows + _busyWindows;
+		//idle windows alone only show the rom waiting, menus and title screens would save a crawl
+		if (evidence == 0)
+			return false;
+		return GetLearnedSpeed() >= configured || evidence >= MinEvidence;
+	}
+
+	bool SpeedTuner::IsLoop(u16 addr) const
+	{ return std::find(_loops.begin(), _loops.end(), addr) != _loops.end(); }
+
+	void SpeedTuner::AddLoop(u16 addr)
+	{
+		if (IsLoop(addr))
+			return;
+		std::copy_backward(_loops.begin(), _loops.end() - 1, _loops.end());
+		_loops[0] = addr;
+	}
+
+	bool SpeedTuner::OnDelayRead(u16 addr, u8 value)
+	{
+		if (value && addr == _readAddr && value == _readValue)
+		{
+			AddLoop(addr);
+			_waitingAt = addr;
+			return true;
+		}
+
+		if (value == 0 && IsLoop(addr))
+		{
+			//leaving the loop we idled in is on time, reaching it after expiry is not
+			if (_waitingAt != addr)
+				_late = true;
+			_waitingAt = NoAddr;
+		}
+		_readAddr = addr;
+		_readValue = value;
+		return false;
+	}
+
+	void SpeedTuner::EndFrame(uint configured, uint executed, bool idle, bool waitingInput)
+	{
+		//untuned roms keep their configured speed, limits only apply to adjusted values
+		if (!IsTuned())
+			_speed = configured;
+		if (waitingInput)
+			return;
+
+		++_frames;
+		if (idle)
+		{
+			++_idleFrames;
+			_peak = std::max(_peak, executed);
+		}
+		else
+			++_busyFrames;
+		if (_late)
+			++_lateFrames;
+
+		if (_frames < Window)
+			return;
+
+		if (IsTuned())
+		{
+			if (_lateFrames)
+			{
+				//back to the heaviest known load at once, grow beyond it gradually
+				++_lateWindows;
+				_speed = std::max(_speed + _speed / 4 + 1, _required);
+				_speed = std::min(MaxSpeed, std::max(MinSpeed, _speed));
+				_required = std::max(_required, _speed);
+			}
+			else if (_idleFrames && !_busyFrames)
+			{
+				//halfway towards peak work plus a quarter of headroom
+				uint target = std::max(MinSpeed, _peak + _peak / 4);
+				_required = std::max(_required, target);
+				if (target < _speed)
+					_speed = std::max(MinSpeed, _speed - (_speed - target + 1) / 2);
+			}
+			if (_busyFrames * 2 >= Window)
+				++_busyWindows;
+		}
+		_frames = _idleFrames = _busyFrames = _lateFrames = 0;
+		_peak = 0;
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef SPEEDTUNER_H
+#define SPEEDTUNER_H
+
+#include <chip8/types.h>
+#include <algorithm>
+#include <array>
+
+namespace chip8
+{
+	///learns instructions per frame for roms pacing themselves with the delay timer
+	///a second FX07 at the same address reading the same non-zero value is a spin loop: the rest of the frame is idle
+	///arriving at a known spin loop with the timer already expired means the logic ran late and needs more budget
+	///roms too slow to ever spin are recognised by the usual vX := delay, skip, jump back code
+	class SpeedTuner
+	{
+		static constexpr uint Window	= 30;	//frames between adjustments
+		static constexpr uint MinSpeed	= 20;
+		static constexpr uint MaxSpeed	= 200000;
+		static constexpr uint MaxLoops	= 4;
+		static constexpr uint MinEvidence	= 10;	//busy or late windows needed to save a speed below configured
+		static constexpr u16 NoAddr		= 0xffff;
+
+		uint					_speed;		//0 until first frame
+		std::array<u16, MaxLoops>	_loops;		//addresses of detected spin loops
+		u16						_waitingAt;	//spin loop the rom was idling in at end of last frame
+		u16						_readAddr;	//last FX07 in current frame
+		u8						_readValue;
+		bool					_late;
+
+		uint					_frames, _idleFrames, _busyFrames, _lateFrames;
+		uint					_peak;		//most instructions before idling in current window
+		uint					_required;	//most budget needed in any window so far
+		uint					_lateWindows, _busyWindows; //windows which showed real load, busy if half the frames never idled
+
+		bool IsLoop(u16 addr) const;
+		void AddLoop(u16 addr);
+
+	public:
+		SpeedTuner() { Reset(); }
+
+		void Reset();
+
+		///budget for next frame, configured speed until tuning starts
+		uint GetSpeed(uint configured) const
+		{ return _speed? _speed: configured; }
+
+		///true once a delay timer spin loop was seen, only then the learned speed means anything
+		bool IsTuned() const
+		{ return _loops[0] != NoAddr; }
+
+		///budget covering the heaviest part of the session so far, current speed may be lower after quiet periods
+		uint GetLearnedSpeed() const
+		{ return std::max(_required, MinSpeed); }
+
+		///learned speed was measured under load, not just while the rom was waiting, and is worth saving
+		bool IsConfident(uint configured) const;
+
+		void BeginFrame()
+		{
+			_readAddr = NoAddr;
+			_late = false;
+		}
+
+		///called for FX07, returns true if rom started spinning and the frame can end here
+		///waitLoop tells if code at addr looks like a delay wait loop, only asked for when value is zero
+		template<typename WaitLoop>
+		bool OnDelayRead(u16 addr, u8 value, WaitLoop waitLoop)
+		{
+			if (value == 0 && !IsLoop(addr) && waitLoop())
+				AddLoop(addr);
+			return OnDelayRead(addr, value);
+		}
+
+		bool OnDelayRead(u16 addr, u8 value);
+
+		///executed instructions of frame, idle if it ended in a spin loop
+		void EndFrame(uint configured, uint executed, bool idle, bool waitingInput);
+	};
+}
+
+#endif
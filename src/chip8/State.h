@@ -0,0 +1,94 @@
+#ifndef STATE_H
+#define STATE_H
+
+#include <chip8/types.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///appends little-endian values to machine state snapshot
+	class StateWriter
+	{
+		std::vector<u8> &	_data;
+
+	public:
+		StateWriter(std::vector<u8> &data): _data(data) { }
+
+		void Write8(u8 value)
+		{ _data.push_back(value); }
+
+		void Write16(u16 value)
+		{ Write8(value); Write8(value >> 8); }
+
+		void Write32(u32 value)
+		{ Write16(value); Write16(value >> 16); }
+
+		void Write64(u64 value)
+		{ Write32(value); Write32(value >> 32); }
+
+		void Write(const void *data, size_t size)
+		{
+			auto bytes = static_cast<const u8 *>(data);
+			_data.insert(_data.end(), bytes, bytes + size);
+		}
+
+		void WriteString(const std::string &str)
+		{
+			Write16(str.size());
+			Write(str.data(), str.size());
+		}
+	};
+
+	///reads snapshot written by StateWriter, throws on truncated data
+	class StateReader
+	{
+		const u8 *	_data;
+		size_t		_size;
+		size_t		_pos;
+
+		const u8 *Take(size_t size)
+		{
+			if (size > _size - _pos)
+				throw std::runtime_error("truncated state");
+			const u8 *data = _data + _pos;
+			_pos += size;
+			return data;
+		}
+
+	public:
+		StateReader(const u8 *data, size_t size): _data(data), _size(size), _pos(0) { }
+
+		u8 Read8()
+		{ return *Take(1); }
+
+		u16 Read16()
+		{ u16 lo = Read8(); return lo | (Read8() << 8); }
+
+		u32 Read32()
+		{ u32 lo = Read16(); return lo | (static_cast<u32>(Read16()) << 16); }
+
+		u64 Read64()
+		{ u64 lo = Read32(); return lo | (static_cast<u64>(Read32()) << 32); }
+
+		void Read(void *data, size_t size)
+		{
+			auto src = Take(size);
+			std::copy(src, src + size, static_cast<u8 *>(data));
+		}
+
+		std::string ReadString()
+		{
+			size_t size = Read16();
+			auto src = Take(size);
+			return std::string(src, src + size);
+		}
+
+		bool AtEnd() const
+		{ return _pos == _size; }
+	};
+}
+
+#endif
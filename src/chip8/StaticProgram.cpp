@@ -0,0 +1,64 @@
+#include <chip8/StaticProgram.h>
+#include <chip8/Chip8.h>
+#include <chip8/Config.h>
+#include <chip8/Backend.h>
+#include <algorithm>
+#include <string.h>
+#include <vector>
+
+namespace chip8
+{
+	namespace
+	{
+		static constexpr u16 EntryPoint = 0x200;
+
+		std::vector<const StaticProgram *> & GetPrograms()
+		{
+			static std::vector<const StaticProgram *> programs;
+			return programs;
+		}
+	}
+
+	StaticContext::StaticContext(Chip8 & chip):
+		Chip(chip), V(chip._reg.data()), I(chip._i), PC(chip._pc),
+		Delay(chip._delay), DelayRead(chip._delayRead), ShiftQuirk(chip._config.Quirks.Shift)
+	{ }
+
+	bool StaticContext::Key(u8 index)
+	{ return Chip._backend.GetKeyState(index); }
+
+	void StaticContext::Call(u16 ret, u16 target)
+	{
+		if (Chip._sp >= Chip._stack.size())
+		{
+			//generated code returns right after Call, the block ends here as in the interpreter
+			Chip.RaiseFault(Fault::StackOverflow, 0x2000 | (target & 0x0fff));
+			return;
+		}
+		Chip._stack[Chip._sp++] = ret;
+		PC = target;
+	}
+
+	void StaticContext::Interpret(u16 addr)
+	{
+		PC = addr;
+		Chip.Execute();
+	}
+
+	bool StaticProgram::IsIntact(const u8 * memory, const StaticBlock & block) const
+	{
+		size_t end = std::min<size_t>(block.End, EntryPoint + RomSize);
+		return memcmp(memory + block.Begin, Rom + (block.Begin - EntryPoint), end - block.Begin) == 0;
+	}
+
+	const StaticProgram * StaticProgram::Find(const u8 * rom, size_t size)
+	{
+		for(auto program : GetPrograms())
+			if (program->RomSize == size && memcmp(program->Rom, rom, size) == 0)
+				return program;
+		return nullptr;
+	}
+
+	StaticProgram::Registrar::Registrar(const StaticProgram & program)
+	{ GetPrograms().push_back(&program); }
+}
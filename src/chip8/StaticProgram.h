@@ -0,0 +1,57 @@
+#ifndef STATICPROGRAM_H
+#define STATICPROGRAM_H
+
+#include <chip8/types.h>
+#include <stddef.h>
+
+namespace chip8
+{
+	class Chip8;
+
+	///state view passed to recompiled blocks
+	struct StaticContext
+	{
+		Chip8 &		Chip;
+		u8 *		V;
+		u16 &		I;
+		u16 &		PC;
+		u8 &		Delay;
+		bool &		DelayRead;
+		const bool &ShiftQuirk;
+
+		StaticContext(Chip8 & chip);
+
+		bool Key(u8 index);
+		///raises StackOverflow instead of calling if stack is full, block must return right after
+		void Call(u16 ret, u16 target);
+		///runs single instruction at addr through the interpreter
+		void Interpret(u16 addr);
+	};
+
+	struct StaticBlock
+	{
+		u16		Begin, End;	//rom bytes [Begin, End) the block was compiled from
+		u16		Count;		//instructions executed by Run
+		uint	(*Run)(StaticContext & context);
+	};
+
+	///rom translated to C++ by xomod-recompile, registers itself on startup
+	struct StaticProgram
+	{
+		const char *		Name;
+		const u8 *			Rom;
+		size_t				RomSize;
+		const StaticBlock *	Blocks;
+		size_t				BlockCount;
+
+		///false if guest code was modified since load
+		bool IsIntact(const u8 * memory, const StaticBlock & block) const;
+
+		static const StaticProgram * Find(const u8 * rom, size_t size);
+
+		struct Registrar
+		{ Registrar(const StaticProgram & program); };
+	};
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include <chip8/Timeline.h>
+#include <chip8/File.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <vector>
+
+namespace chip8
+{
+	std::atomic<bool> Timeline::_enabled(false);
+
+	namespace
+	{
+		static constexpr size_t MaxEvents = 1 << 20; //per thread, later zones are dropped
+
+		struct Event
+		{
+			const char *	Name;
+			u64				Begin, End;
+		};
+
+		///owner appends under its own lock, which is contended only while saving
+		struct Buffer
+		{
+			std::mutex					Lock;
+			std::vector<Event>			Events;
+			std::atomic<const char *>	Name;
+			uint						Tid;
+			size_t						Dropped;
+
+			Buffer(uint tid): Name(nullptr), Tid(tid), Dropped(0) { }
+		};
+
+		struct Registry
+		{
+			std::mutex							Lock;
+			std::vector<std::unique_ptr<Buffer>>	Buffers;
+			u64									Started = 0;
+		};
+
+		Registry & GetRegistry()
+		{
+			static Registry registry;
+			return registry;
+		}
+
+		Buffer & GetBuffer()
+		{
+			thread_local Buffer *buffer = nullptr;
+			if (!buffer)
+			{
+				auto &registry = GetRegistry();
+				std::lock_guard<std::mutex> l(registry.Lock);
+				registry.Buffers.emplace_back(new Buffer(registry.Buffers.size() + 1));
+				buffer = registry.Buffers.back().get();
+			}
+			return *buffer;
+		}
+	}
+
+	u64 Timeline::Now()
+	{ return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+	void Timeline::Enable()
+	{
+		{
+			auto &registry = GetRegistry();
+			std::lock_guard<std::mutex> l(registry.Lock);
+			registry.Started = Now();
+		}
+		_enabled = true;
+	}
+
+	void Timeline::SetThreadName(const char *name)
+	{ GetBuffer().Name.store(name, std::memory_order_relaxed); }
+
+	void Timeline::Record(const char *name, u64 begin, u64 end)
+	{
+		auto &buffer = GetBuffer();
+		std::lock_guard<std::mutex> l(buffer.Lock);
+		if (buffer.Events.size() < MaxEvents)
+			buffer.Events.push_back({ name, begin, end });
+		else
+			++buffer.Dropped;
+	}
+
+	void Timeline::Save(const std::string &path)
+	{
+		File file(path, "wb");
+		std::string text = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		bool first = true;
+		auto flush = [&]()
+		{
+			file.Write(text.data(), text.size());
+			text.clear();
+		};
+
+		auto &registry = GetRegistry();
+		std::lock_guard<std::mutex> l(registry.Lock);
+		for(auto &buffer : registry.Buffers)
+		{
+			std::lock_guard<std::mutex> bl(buffer->Lock);
+			char line[256];
+			if (auto name = buffer->Name.load(std::memory_order_relaxed))
+			{
+				snprintf(line, sizeof(line), "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+					first? "": ",\n", buffer->Tid, name);
+				text += line;
+				first = false;
+			}
+			if (buffer->Dropped)
+				fprintf(stderr, "timeline: dropped %zu zones on thread %u\n", buffer->Dropped, buffer->Tid);
+
+			for(auto &event : buffer->Events)
+			{
+				//zones begun before Enable are clamped to zero
+				u64 begin = event.Begin > registry.Started? event.Begin - registry.Started: 0;
+				snprintf(line, sizeof(line), "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+					first? "": ",\n", event.Name, buffer->Tid, begin / 1000.0, (event.End - event.Begin) / 1000.0);
+				text += line;
+				first = false;
+				if (text.size() > 0x10000)
+					flush();
+			}
+		}
+		text += "\n]}\n";
+		flush();
+	}
+}
@@ -0,0 +1,51 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <chip8/types.h>
+#include <atomic>
+#include <string>
+
+namespace chip8
+{
+	///wall clock zones per thread, saved in Chrome trace event format for chrome://tracing or Perfetto
+	///zones cost one relaxed load while disabled
+	class Timeline
+	{
+		static std::atomic<bool> _enabled;
+
+		static u64 Now();
+		static void Record(const char *name, u64 begin, u64 end);
+
+	public:
+		///measures its own lifetime, name must be a string literal
+		class Zone
+		{
+			const char *	_name;
+			u64				_begin;
+
+		public:
+			explicit Zone(const char *name): _name(name), _begin(IsEnabled()? Now(): 0) { }
+			~Zone()
+			{
+				if (_begin)
+					Record(_name, _begin, Now());
+			}
+
+			Zone(const Zone &) = delete;
+			Zone& operator = (const Zone &) = delete;
+		};
+
+		static bool IsEnabled()
+		{ return _enabled.load(std::memory_order_relaxed); }
+
+		static void Enable();
+
+		///label for calling thread in saved trace, name must be a string literal
+		static void SetThreadName(const char *name);
+
+		///writes zones recorded so far as JSON trace
+		static void Save(const std::string &path);
+	};
+}
+
+#endif
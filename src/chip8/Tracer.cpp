@@ -0,0 +1,84 @@
+#include <chip8/Tracer.h>
+#include <chrono>
+#include <string.h>
+
+namespace chip8
+{
+	constexpr char Tracer::Magic[4];
+
+	void TraceRecord::Pack(u8 *dst) const
+	{
+		dst[0] = PC;	dst[1] = PC >> 8;
+		dst[2] = Op;	dst[3] = Op >> 8;
+		dst[4] = I;		dst[5] = I >> 8;
+		dst[6] = Reg;
+		dst[7] = Value;
+	}
+
+	void TraceRecord::Unpack(const u8 *src)
+	{
+		PC		= src[0] | (src[1] << 8);
+		Op		= src[2] | (src[3] << 8);
+		I		= src[4] | (src[5] << 8);
+		Reg		= src[6];
+		Value	= src[7];
+	}
+
+	Tracer::Tracer(const std::string &path):
+		_file(path, "wb"), _buffer(Capacity), _head(0), _tail(0), _running(true)
+	{
+		_file.Write(Magic, sizeof(Magic));
+		_thread = std::thread([this]() { Run(); });
+	}
+
+	Tracer::~Tracer()
+	{
+		_running = false;
+		_thread.join();
+		while(Flush());
+	}
+
+	size_t Tracer::Flush()
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		size_t head = _head.load(std::memory_order_acquire);
+		if (head == tail)
+			return 0;
+
+		static constexpr size_t Batch = 4096;
+		u8 packed[Batch * TraceRecord::Size];
+		size_t n = 0;
+		for(; tail != head && n < Batch; ++tail, ++n)
+			_buffer[tail & (Capacity - 1)].Pack(packed + n * TraceRecord::Size);
+
+		_tail.store(tail, std::memory_order_release);
+		_file.Write(packed, n * TraceRecord::Size);
+		return n;
+	}
+
+	void Tracer::Run()
+	{
+		while(_running)
+		{
+			if (!Flush())
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	std::vector<TraceRecord> Tracer::Load(const std::string &path)
+	{
+		File file(path, "rb");
+		auto data = file.ReadAll<std::vector<u8>>();
+		if (data.size() < sizeof(Magic) || memcmp(data.data(), Magic, sizeof(Magic)) != 0)
+			throw std::runtime_error("invalid trace file " + path);
+
+		std::vector<TraceRecord> records((data.size() - sizeof(Magic)) / TraceRecord::Size);
+		const u8 *src = data.data() + sizeof(Magic);
+		for(auto & record : records)
+		{
+			record.Unpack(src);
+			src += TraceRecord::Size;
+		}
+		return records;
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <chip8/File.h>
+#include <chip8/types.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace chip8
+{
+	struct TraceRecord
+	{
+		static constexpr u8 NoRegister	= 0xff;
+		static constexpr size_t Size	= 8; //packed little-endian size in trace file
+
+		u16		PC;
+		u16		Op;
+		u16		I;
+		u8		Reg;	//first register changed by instruction or NoRegister
+		u8		Value;
+
+		void Pack(u8 *dst) const;
+		void Unpack(const u8 *src);
+	};
+
+	///single producer ring buffer drained into trace file by background thread
+	class Tracer
+	{
+		static constexpr size_t Capacity	= 1 << 16;
+		static constexpr char Magic[4]		= { 'X', 'O', 'T', 'R' };
+
+		File						_file;
+		std::vector<TraceRecord>	_buffer;
+		std::atomic<size_t>			_head;
+		std::atomic<size_t>			_tail;
+		std::atomic<bool>			_running;
+		std::thread					_thread;
+
+		void Run();
+		size_t Flush();
+
+	public:
+		Tracer(const std::string &path);
+		~Tracer();
+
+		Tracer(const Tracer &) = delete;
+		Tracer& operator = (const Tracer &) = delete;
+
+		void Write(const TraceRecord &record)
+		{
+			size_t head = _head.load(std::memory_order_relaxed);
+			while (head - _tail.load(std::memory_order_acquire) >= Capacity)
+				std::this_thread::yield(); //never drop records, wait for writer
+			_buffer[head & (Capacity - 1)] = record;
+			_head.store(head + 1, std::memory_order_release);
+		}
+
+		///reads whole trace file
+		static std::vector<TraceRecord> Load(const std::string &path);
+	};
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef PROXYBACKEND_H
+#define PROXYBACKEND_H
+
+#include <chip8/Backend.h>
+
+namespace chip8
+{
+	class ProxyBackend : public Backend
+	{
+	protected:
+		Backend &	_backend;
+
+	public:
+		ProxyBackend(Backend & backend): _backend(backend) { }
+
+		void PollInput(std::chrono::steady_clock::time_point time) override
+		{ _backend.PollInput(time); }
+
+		bool ProcessEvents(Framebuffer & fb) override
+		{ return _backend.ProcessEvents(fb); }
+
+		bool Render(Framebuffer & fb) override
+		{ return _backend.Render(fb); }
+
+		bool GetKeyState(u8 index) override
+		{ return _backend.GetKeyState(index); }
+
+		void SetAudio(Audio *audio) override
+		{ _backend.SetAudio(audio); }
+	};
+}
+
+#endif
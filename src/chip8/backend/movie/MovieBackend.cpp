@@ -0,0 +1,26 @@
+#include <chip8/backend/movie/MovieBackend.h>
+#include <chip8/Movie.h>
+
+namespace chip8
+{
+	bool MovieRecorder::ProcessEvents(Framebuffer & fb)
+	{
+		bool running = _backend.ProcessEvents(fb);
+		_movie.Append(_keys);
+
+		_keys = 0;
+		for(u8 i = 0; i < 16; ++i)
+			if (_backend.GetKeyState(i))
+				_keys |= 1 << i;
+		return running;
+	}
+
+	bool MoviePlayer::ProcessEvents(Framebuffer & fb)
+	{
+		bool running = _backend.ProcessEvents(fb);
+		return ++_frame < _movie.GetSize() && running;
+	}
+
+	bool MoviePlayer::GetKeyState(u8 index)
+	{ return index < 16? _movie.Get(_frame) & (1 << index): false; }
+}
@@ -0,0 +1,41 @@
+#ifndef MOVIEBACKEND_H
+#define MOVIEBACKEND_H
+
+#include <chip8/backend/ProxyBackend.h>
+
+namespace chip8
+{
+	class Movie;
+
+	///latches key state once per frame and appends it to the movie
+	class MovieRecorder : public ProxyBackend
+	{
+		Movie &		_movie;
+		u16			_keys;
+
+	public:
+		MovieRecorder(Backend & backend, Movie & movie): ProxyBackend(backend), _movie(movie), _keys(0) { }
+
+		bool ProcessEvents(Framebuffer & fb) override;
+		bool GetKeyState(u8 index) override
+		{ return index < 16? _keys & (1 << index): false; }
+	};
+
+	///feeds key state from the movie, stops at the last frame
+	class MoviePlayer : public ProxyBackend
+	{
+		const Movie &	_movie;
+		size_t			_frame;
+
+	public:
+		MoviePlayer(Backend & backend, const Movie & movie): ProxyBackend(backend), _movie(movie), _frame(0) { }
+
+		size_t GetFrame() const
+		{ return _frame; }
+
+		bool ProcessEvents(Framebuffer & fb) override;
+		bool GetKeyState(u8 index) override;
+	};
+}
+
+#endif
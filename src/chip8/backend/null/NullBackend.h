@@ -0,0 +1,17 @@
+#ifndef NULLBACKEND_H
+#define NULLBACKEND_H
+
+#include <chip8/Backend.h>
+
+namespace chip8
+{
+	class NullBackend : public Backend
+	{
+	public:
+		bool Render(Framebuffer & fb) override { return true; }
+		bool GetKeyState(u8 index) override { return false; }
+		void SetAudio(Audio *audio) override { }
+	};
+}
+
+#endif
@@ -2,9 +2,11 @@
 #include <chip8/Audio.h>
 #include <chip8/Config.h>
 #include <chip8/Framebuffer.h>
+#include <chip8/Timeline.h>
 #include <SDL2pp/AudioSpec.hh>
 #include <SDL.h>
 #include <algorithm>
+#include <chrono>
 
 namespace chip8
 {
@@ -15,7 +17,11 @@ namespace chip8
 		_renderer(_window, -1, SDL_RENDERER_ACCELERATED),
 		_spec(SampleFreq, AUDIO_S16, 1, SampleFreq / 60),
 		_audio(nullptr),
-		_keys(),
+		_chipW(64), _chipH(32),
+		_quit(false),
+		_redraw(false),
+		_overlay(false),
+		_metrics(Metrics::Collect()),
 		_audioDevice
 		(
 			SDL2pp::Optional<std::string>(), false,
@@ -32,83 +38,127 @@ namespace chip8
 		SDL2Backend::SetAudio(nullptr);
 	}
 
-	bool SDL2Backend::Render(Framebuffer & fb)
+	void SDL2Backend::PollEvents()
 	{
-		int chipW = fb.GetWidth(), chipH = fb.GetHeight();
+		Timeline::Zone zone("PollEvents");
 		int num, denom, offsetX, offsetY;
-		CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), chipW, chipH);
+		CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), _chipW, _chipH);
 
-		bool running = true;
+		SDL_Event event;
+		while(SDL_PollEvent(&event))
 		{
-			SDL_Event event;
-			while(SDL_PollEvent(&event))
+			switch(event.type)
 			{
-				switch(event.type)
+			case SDL_QUIT:
+				_quit = true;
+				break;
+			case SDL_WINDOWEVENT:
+				_redraw = true; //exposed, resized or restored
+				break;
+			case SDL_KEYDOWN:
+			case SDL_KEYUP:
 				{
-				case SDL_QUIT:
-					running = false;
-					break;
-				case SDL_KEYDOWN:
-				case SDL_KEYUP:
+					bool state = event.type == SDL_KEYDOWN;
+					int key = -1;
+					switch(event.key.keysym.sym)
 					{
-						bool state = event.type == SDL_KEYDOWN;
-						switch(event.key.keysym.sym)
+					case SDLK_1: key = 0x1; break;
+					case SDLK_2: key = 0x2; break;
+					case SDLK_3: key = 0x3; break;
+					case SDLK_4: key = 0xc; break;
+					case SDLK_q: key = 0x4; break;
+					case SDLK_w: key = 0x5; break;
+					case SDLK_e: key = 0x6; break;
+					case SDLK_r: key = 0xd; break;
+					case SDLK_a: key = 0x7; break;
+					case SDLK_s: key = 0x8; break;
+					case SDLK_d: key = 0x9; break;
+					case SDLK_f: key = 0xe; break;
+					case SDLK_z: key = 0xa; break;
+					case SDLK_x: key = 0x0; break;
+					case SDLK_c: key = 0xb; break;
+					case SDLK_v: key = 0xf; break;
+
+					case SDLK_PLUS:
+					case SDLK_EQUALS:
+						if (state)
+						{
+							int w = (num + 1) * _chipW, h = (num + 1) * _chipH;
+							fprintf(stderr, "setting window size to %dx%d\n", w, h);
+							_window.SetSize(w, h);
+							CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), _chipW, _chipH);
+							_redraw = true;
+						}
+						break;
+
+					case SDLK_MINUS:
+						if (state && num > 1)
+						{
+							int w = (num - 1) * _chipW, h = (num - 1) * _chipH;
+							fprintf(stderr, "setting window size to %dx%d\n", w, h);
+							_window.SetSize(w, h);
+							CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), _chipW, _chipH);
+							_redraw = true;
+						}
+						break;
+					case SDLK_F1:
+						if (state)
+						{
+							_overlay = !_overlay;
+							_redraw = true;
+						}
+						break;
+
+					case SDLK_RETURN:
+						if (state && (event.key.keysym.mod & KMOD_LALT))
 						{
-						case SDLK_1: _keys[0x1] = state; break;
-						case SDLK_2: _keys[0x2] = state; break;
-						case SDLK_3: _keys[0x3] = state; break;
-						case SDLK_4: _keys[0xc] = state; break;
-						case SDLK_q: _keys[0x4] = state; break;
-						case SDLK_w: _keys[0x5] = state; break;
-						case SDLK_e: _keys[0x6] = state; break;
-						case SDLK_r: _keys[0xd] = state; break;
-						case SDLK_a: _keys[0x7] = state; break;
-						case SDLK_s: _keys[0x8] = state; break;
-						case SDLK_d: _keys[0x9] = state; break;
-						case SDLK_f: _keys[0xe] = state; break;
-						case SDLK_z: _keys[0xa] = state; break;
-						case SDLK_x: _keys[0x0] = state; break;
-						case SDLK_c: _keys[0xb] = state; break;
-						case SDLK_v: _keys[0xf] = state; break;
-
-						case SDLK_PLUS:
-						case SDLK_EQUALS:
-							if (state)
-							{
-								int w = (num + 1)* fb.GetWidth(), h = (num + 1) * fb.GetHeight();
-								fprintf(stderr, "setting window size to %dx%d\n", w, h);
-								_window.SetSize(w, h);
-								CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), chipW, chipH);
-							}
-							break;
-
-						case SDLK_MINUS:
-							if (state && num > 1)
-							{
-								int w = (num - 1)* fb.GetWidth(), h = (num - 1) * fb.GetHeight();
-								fprintf(stderr, "setting window size to %dx%d\n", w, h);
-								_window.SetSize(w, h);
-								CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), chipW, chipH);
-							}
-							break;
-						case SDLK_RETURN:
-							if (state && (event.key.keysym.mod & KMOD_LALT))
-							{
-								auto flags = _window.GetFlags();
-								bool fullscreen = (flags & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP;
-								_window.SetFullscreen(fullscreen? flags & ~SDL_WINDOW_FULLSCREEN_DESKTOP: flags | SDL_WINDOW_FULLSCREEN_DESKTOP);
-							}
-							break;
+							auto flags = _window.GetFlags();
+							bool fullscreen = (flags & SDL_WINDOW_FULLSCREEN_DESKTOP) == SDL_WINDOW_FULLSCREEN_DESKTOP;
+							_window.SetFullscreen(fullscreen? flags & ~SDL_WINDOW_FULLSCREEN_DESKTOP: flags | SDL_WINDOW_FULLSCREEN_DESKTOP);
 						}
+						break;
+					}
+					if (key >= 0)
+					{
+						//SDL stamps events in milliseconds since init when they are queued
+						auto age = std::chrono::milliseconds(SDL_GetTicks() - event.key.timestamp);
+						_keys.Push(key, state, KeyQueue::clock::now() - age);
 					}
-					break;
 				}
+				break;
 			}
 		}
+	}
+
+	void SDL2Backend::PollInput(KeyQueue::clock::time_point time)
+	{
+		PollEvents();
+		_keys.Apply(time);
+	}
+
+	bool SDL2Backend::ProcessEvents(Framebuffer & fb)
+	{
+		_chipW = fb.GetWidth();
+		_chipH = fb.GetHeight();
+		PollEvents();
+		_keys.Apply(KeyQueue::clock::now());
+
+		//overlay graphs change every frame
+		if (_redraw || _overlay)
+			fb.Invalidate();
+		_redraw = false;
+		return !_quit;
+	}
+
+	bool SDL2Backend::Render(Framebuffer & fb)
+	{
+		int chipW = fb.GetWidth(), chipH = fb.GetHeight();
+		int num, denom, offsetX, offsetY;
+		CalculateZoom(num, denom, offsetX, offsetY, _window.GetWidth(), _window.GetHeight(), chipW, chipH);
 
 		//printf("num %d, offset: %d, %d\n", num, offsetX, offsetY);
 		if  (denom > 1)
-			return running;
+			return true;
 
 		auto & P = _config.Palette;
 
@@ -126,6 +176,7 @@ namespace chip8
 			{ P.Buzz.R, P.Buzz.G, P.Buzz.B, 0xff },
 		};
 
+		Timeline::Zone draw("Draw");
 		bool buzz = _audio? _audio->GetCurrentBit(): false;
 		_renderer.SetDrawColor(border[buzz? 1: 0]);
 		_renderer.Clear();
@@ -141,13 +192,18 @@ namespace chip8
 				_renderer.FillRect(rect);
 			}
 		}
-		_renderer.Present();
+		if (_overlay)
+			RenderOverlay();
+		{
+			Timeline::Zone present("Present"); //includes vsync wait
+			_renderer.Present();
+		}
 
-		return running;
+		return true;
 	}
 
 	bool SDL2Backend::GetKeyState(u8 index)
-	{ return index < _keys.size()? _keys[index]: false; }
+	{ return _keys.Get(index); }
 
 	void SDL2Backend::SetAudio(Audio *audio)
 	{
@@ -155,13 +211,54 @@ namespace chip8
 		_audio = audio;
 	}
 
+	void SDL2Backend::RenderOverlay()
+	{
+		using H = Metrics::Histogram;
+		auto metrics = Metrics::Collect();
+		auto mean = [&](H h) -> double
+		{
+			auto i = static_cast<uint>(h);
+			u64 count = metrics.Histograms[i].Count - _metrics.Histograms[i].Count;
+			return count? double(metrics.Histograms[i].Sum - _metrics.Histograms[i].Sum) / count: 0;
+		};
+
+		//bars relative to one 60Hz frame, audio callbacks are one frame long as well
+		static constexpr int Width = 240, Height = 8;
+		static constexpr double FrameNs = 1e9 / 60;
+		struct Bar { double Value; SDL_Color Color; };
+		Bar bars[] =
+		{
+			{ mean(H::ExecNs) / FrameNs,			{ 0xe0, 0x40, 0x40, 0xff } },
+			{ mean(H::RenderNs) / FrameNs,			{ 0x40, 0xe0, 0x40, 0xff } },
+			{ mean(H::SleepNs) / FrameNs,			{ 0x40, 0x40, 0xe0, 0xff } },
+			{ mean(H::AudioCallbackNs) / FrameNs,	{ 0xe0, 0xe0, 0x40, 0xff } },
+			{ mean(H::InstructionsPerFrame) / std::max<uint>(_config.Core.Speed, 1), { 0xe0, 0xe0, 0xe0, 0xff } },
+		};
+		_metrics = metrics;
+
+		int y = 4;
+		for(auto &bar : bars)
+		{
+			_renderer.SetDrawColor(0, 0, 0, 0xff);
+			_renderer.FillRect(SDL2pp::Rect(4, y, Width, Height));
+			_renderer.SetDrawColor(bar.Color);
+			_renderer.FillRect(SDL2pp::Rect(4, y, std::min<int>(Width, bar.Value * Width), Height));
+			y += Height + 2;
+		}
+	}
+
 	void SDL2Backend::Generate(Uint8* stream, int len)
 	{
+		if (Timeline::IsEnabled())
+			Timeline::SetThreadName("audio");
+		Timeline::Zone zone("AudioCallback");
+		auto started = std::chrono::steady_clock::now();
 		if (!_audio)
-		{
 			std::fill(stream, stream + len, 0);
-			return;
-		}
-		_audio->Generate(_spec.freq, reinterpret_cast<s16 *>(stream), len / 2);
+		else
+			_audio->Generate(_spec.freq, reinterpret_cast<s16 *>(stream), len / 2);
+		Metrics::Add(Metrics::Counter::AudioCallbacks);
+		Metrics::Record(Metrics::Histogram::AudioCallbackNs,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - started).count());
 	}
 }
@@ -2,6 +2,8 @@
 #define SDL2BACKEND_H
 
 #include <chip8/Backend.h>
+#include <chip8/KeyQueue.h>
+#include <chip8/Metrics.h>
 #include <array>
 #include <SDL2pp/SDL.hh>
 #include <SDL2pp/Window.hh>
@@ -23,17 +25,27 @@ namespace chip8
 		SDL2pp::AudioSpec			_spec;
 		Audio *						_audio;
 
-		std::array<bool, 16>		_keys;
+		KeyQueue					_keys;
+		int							_chipW, _chipH; //resolution of last processed frame, for zoom keys
+		bool						_quit;
+		bool						_redraw;
+		bool						_overlay;
+		Metrics::Snapshot			_metrics; //previous snapshot, overlay shows averages since then
 
 		SDL2pp::AudioDevice			_audioDevice; //leave last member, can call back early
 
 	private:
 		void Generate(Uint8* stream, int len);
+		///drains SDL event queue, keys are queued with their timestamps
+		void PollEvents();
+		void RenderOverlay();
 
 	public:
 		SDL2Backend(Config & config);
 		~SDL2Backend();
 
+		void PollInput(KeyQueue::clock::time_point time) override;
+		bool ProcessEvents(Framebuffer & fb) override;
 		bool Render(Framebuffer & fb) override;
 		bool GetKeyState(u8 index) override;
 		void SetAudio(Audio *audio) override;
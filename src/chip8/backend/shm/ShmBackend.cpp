@@ -0,0 +1,126 @@
+#include <chip8/backend/shm/ShmBackend.h>
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	namespace
+	{
+		ShmFrame *Map(const std::string &name, int flags)
+		{
+			auto path = "/" + name;
+			int fd = shm_open(path.c_str(), flags | O_CLOEXEC, 0600);
+			if (fd < 0)
+				throw std::runtime_error("shm_open " + path + ": " + strerror(errno));
+			if ((flags & O_CREAT) && ftruncate(fd, sizeof(ShmFrame)) != 0)
+			{
+				int error = errno;
+				close(fd);
+				shm_unlink(path.c_str());
+				throw std::runtime_error("ftruncate " + path + ": " + strerror(error));
+			}
+			void *data = mmap(nullptr, sizeof(ShmFrame), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			int error = errno;
+			close(fd);
+			if (data == MAP_FAILED)
+				throw std::runtime_error("mmap " + path + ": " + strerror(error));
+			return static_cast<ShmFrame *>(data);
+		}
+	}
+
+	ShmBackend::ShmBackend(Backend & backend, const std::string &name):
+		ProxyBackend(backend), _name(name), _frame(nullptr), _audio(nullptr)
+	{
+		static_assert(std::atomic<u32>::is_always_lock_free && std::atomic<u16>::is_always_lock_free,
+			"shared memory needs address-free atomics");
+		_frame = new (Map(name, O_RDWR | O_CREAT | O_TRUNC)) ShmFrame();
+		_frame->Signature = ShmFrame::Magic;
+		_frame->LayoutVersion = ShmFrame::Version;
+	}
+
+	ShmBackend::~ShmBackend()
+	{
+		munmap(_frame, sizeof(ShmFrame));
+		shm_unlink(("/" + _name).c_str());
+	}
+
+	bool ShmBackend::Render(Framebuffer & fb)
+	{
+		auto &frame = *_frame;
+		u32 seq = frame.Sequence.load(std::memory_order_relaxed);
+		frame.Sequence.store(seq + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		frame.Width = fb.GetWidth();
+		frame.Height = fb.GetHeight();
+		frame.Buzzer = _audio? 1: 0;
+		u16 keys = 0;
+		for(u8 i = 0; i < 16; ++i)
+			keys |= GetKeyState(i)? 1 << i: 0;
+		frame.Keys = keys;
+		++frame.Frame;
+		auto data = fb.GetData();
+		uint size = fb.GetWidth() * fb.GetHeight();
+		for(uint i = 0; i < size; ++i)
+			frame.Pixels[i] = data[i] & 0x03;
+
+		frame.Sequence.store(seq + 2, std::memory_order_release);
+		return _backend.Render(fb);
+	}
+
+	bool ShmBackend::GetKeyState(u8 index)
+	{
+		return (index < 16 && (_frame->InputKeys.load(std::memory_order_relaxed) & (1 << index))) ||
+			_backend.GetKeyState(index);
+	}
+
+	void ShmBackend::SetAudio(Audio *audio)
+	{
+		_audio = audio;
+		_backend.SetAudio(audio);
+	}
+
+	ShmReader::ShmReader(const std::string &name): _frame(Map(name, O_RDWR))
+	{
+		if (_frame->Signature != ShmFrame::Magic || _frame->LayoutVersion != ShmFrame::Version)
+		{
+			munmap(_frame, sizeof(ShmFrame));
+			throw std::runtime_error("shared memory segment " + name + " has unknown layout");
+		}
+	}
+
+	ShmReader::~ShmReader()
+	{ munmap(_frame, sizeof(ShmFrame)); }
+
+	u32 ShmReader::Read(ShmFrame &frame) const
+	{
+		auto &src = *_frame;
+		while(true)
+		{
+			u32 seq = src.Sequence.load(std::memory_order_acquire);
+			if (seq & 1)
+				continue;
+
+			frame.Frame = src.Frame;
+			frame.Width = src.Width;
+			frame.Height = src.Height;
+			frame.Buzzer = src.Buzzer;
+			frame.Keys = src.Keys;
+			//torn header is detected below, only size must not overrun
+			memcpy(frame.Pixels, src.Pixels, std::min<size_t>(frame.Width * frame.Height, Framebuffer::MaxSize));
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (src.Sequence.load(std::memory_order_relaxed) == seq)
+			{
+				frame.Sequence.store(seq, std::memory_order_relaxed);
+				return frame.Frame;
+			}
+		}
+	}
+}
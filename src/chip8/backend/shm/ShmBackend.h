@@ -0,0 +1,69 @@
+#ifndef SHMBACKEND_H
+#define SHMBACKEND_H
+
+#include <chip8/backend/ProxyBackend.h>
+#include <chip8/Framebuffer.h>
+#include <atomic>
+#include <string>
+
+namespace chip8
+{
+	///layout of POSIX shared memory segment, other processes map it read-write to read frames and inject keys
+	///Sequence is odd while a frame is being written, readers retry if it changed during their copy
+	struct ShmFrame
+	{
+		static constexpr u32 Magic = 0x42464f58; //"XOFB"
+		static constexpr u32 Version = 1;
+
+		u32					Signature;
+		u32					LayoutVersion;
+		std::atomic<u32>	Sequence;
+		u32					Frame;		//rendered frames, unchanged frames are not published
+		u8					Width, Height;
+		u8					Buzzer;
+		u8					Reserved;
+		u16					Keys;		//key state seen by emulator
+		std::atomic<u16>	InputKeys;	//written by consumers, merged with keys of wrapped backend
+		u8					Pixels[Framebuffer::MaxSize]; //row-major, Width bytes per row, low two bits are planes
+	};
+
+	///publishes every rendered frame into shared memory segment /name, removed on destruction
+	class ShmBackend : public ProxyBackend
+	{
+		std::string	_name;
+		ShmFrame *	_frame;
+		Audio *		_audio;
+
+	public:
+		ShmBackend(Backend & backend, const std::string &name);
+		~ShmBackend();
+
+		ShmBackend(const ShmBackend &) = delete;
+		ShmBackend& operator = (const ShmBackend &) = delete;
+
+		bool Render(Framebuffer & fb) override;
+		bool GetKeyState(u8 index) override;
+		void SetAudio(Audio *audio) override;
+	};
+
+	///maps segment published by ShmBackend in another process
+	class ShmReader
+	{
+		ShmFrame *	_frame;
+
+	public:
+		explicit ShmReader(const std::string &name);
+		~ShmReader();
+
+		ShmReader(const ShmReader &) = delete;
+		ShmReader& operator = (const ShmReader &) = delete;
+
+		///consistent copy of header and pixels, returns frame number
+		u32 Read(ShmFrame &frame) const;
+
+		void SetKeys(u16 keys)
+		{ _frame->InputKeys.store(keys, std::memory_order_relaxed); }
+	};
+}
+
+#endif
@@ -0,0 +1,220 @@
+#include <chip8/backend/stream/Stream.h>
+#include <chip8/Framebuffer.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdexcept>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	namespace stream
+	{
+		namespace
+		{
+			[[noreturn]] void Error(const std::string &what, const std::string &address)
+			{ throw std::runtime_error(what + " " + address + ": " + strerror(errno)); }
+
+			void SetNonBlocking(int fd)
+			{ fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+			///creates socket for address and passes it with resolved address to func, which binds or connects
+			template<typename Func>
+			int Open(const std::string &address, bool passive, Func func)
+			{
+				static const std::string unixPrefix = "unix:";
+				if (address.compare(0, unixPrefix.size(), unixPrefix) == 0)
+				{
+					sockaddr_un addr = {};
+					addr.sun_family = AF_UNIX;
+					auto path = address.substr(unixPrefix.size());
+					if (path.size() >= sizeof(addr.sun_path))
+						throw std::runtime_error("socket path too long: " + path);
+					strcpy(addr.sun_path, path.c_str());
+					if (passive)
+						unlink(addr.sun_path);
+
+					int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+					if (fd < 0 || !func(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)))
+					{
+						int error = errno;
+						if (fd >= 0)
+							close(fd);
+						errno = error;
+						Error("could not open", address);
+					}
+					return fd;
+				}
+
+				auto colon = address.rfind(':');
+				std::string host = colon != address.npos? address.substr(0, colon): std::string("127.0.0.1");
+				std::string port = colon != address.npos? address.substr(colon + 1): address;
+
+				addrinfo hints = {};
+				hints.ai_family = AF_UNSPEC;
+				hints.ai_socktype = SOCK_STREAM;
+				hints.ai_flags = passive? AI_PASSIVE: 0;
+				addrinfo *result;
+				if (int error = getaddrinfo(host.c_str(), port.c_str(), &hints, &result))
+					throw std::runtime_error("could not resolve " + address + ": " + gai_strerror(error));
+
+				int fd = -1;
+				for(auto *ai = result; ai && fd < 0; ai = ai->ai_next)
+				{
+					fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+					if (fd < 0)
+						continue;
+					int one = 1;
+					setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+					if (passive)
+						setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+					if (!func(fd, ai->ai_addr, ai->ai_addrlen))
+					{
+						close(fd);
+						fd = -1;
+					}
+				}
+				freeaddrinfo(result);
+				if (fd < 0)
+					Error("could not open", address);
+				return fd;
+			}
+		}
+
+		int Listen(const std::string &address)
+		{
+			int fd = Open(address, true, [](int fd, const sockaddr *addr, socklen_t size) {
+				return bind(fd, addr, size) == 0 && listen(fd, 8) == 0;
+			});
+			SetNonBlocking(fd);
+			return fd;
+		}
+
+		int Connect(const std::string &address)
+		{
+			int fd = Open(address, false, [](int fd, const sockaddr *addr, socklen_t size) {
+				return connect(fd, addr, size) == 0;
+			});
+			SetNonBlocking(fd);
+			return fd;
+		}
+
+		bool EncodeFrame(std::vector<u8> &payload, const Framebuffer &fb, u8 *previous, bool full)
+		{
+			uint w = fb.GetWidth(), h = fb.GetHeight();
+			payload.push_back(w);
+			payload.push_back(h);
+			size_t header = payload.size();
+
+			auto data = fb.GetData();
+			for(uint y = 0; y < h; ++y)
+			{
+				const u8 *line = data + y * w;
+				u8 *prev = previous + y * w;
+				bool changed = full;
+				for(uint x = 0; x < w; ++x)
+				{
+					u8 value = line[x] & 0x03;
+					changed |= value != prev[x];
+					prev[x] = value;
+				}
+				if (!changed)
+					continue;
+
+				payload.push_back(y);
+				for(uint x = 0; x < w; )
+				{
+					u8 value = prev[x];
+					uint run = 1;
+					while(x + run < w && run < MaxRun && prev[x + run] == value)
+						++run;
+					payload.push_back((value << 6) | (run - 1));
+					x += run;
+				}
+			}
+			return payload.size() != header;
+		}
+
+		void DecodeFrame(Framebuffer &fb, const u8 *payload, size_t size)
+		{
+			if (size < 2)
+				throw std::runtime_error("short frame message");
+			u8 w = payload[0], h = payload[1];
+			if (w == 0 || h == 0 || w > Framebuffer::MaxWidth || h > Framebuffer::MaxHeight)
+				throw std::runtime_error("invalid frame resolution");
+			if (w != fb.GetWidth() || h != fb.GetHeight())
+				fb.SetResolution(w, h);
+
+			for(size_t offset = 2; offset < size; )
+			{
+				u8 y = payload[offset++];
+				if (y >= h)
+					throw std::runtime_error("invalid frame row");
+				u8 *line = fb.GetLine(y);
+				for(uint x = 0; x < w; )
+				{
+					if (offset >= size)
+						throw std::runtime_error("truncated frame row");
+					u8 run = payload[offset++];
+					u8 value = run >> 6;
+					for(uint n = (run & (MaxRun - 1)) + 1; n-- && x < w; ++x)
+						line[x] = value | Framebuffer::DirtyBit;
+				}
+			}
+		}
+
+		Connection::~Connection()
+		{ close(_fd); }
+
+		void Connection::Send(Message type, const u8 *payload, size_t size)
+		{
+			_out.push_back(static_cast<u8>(type));
+			_out.push_back(size);
+			_out.push_back(size >> 8);
+			_out.insert(_out.end(), payload, payload + size);
+		}
+
+		bool Connection::Flush()
+		{
+			size_t offset = 0;
+			while(offset < _out.size())
+			{
+				ssize_t r = send(_fd, _out.data() + offset, _out.size() - offset, MSG_NOSIGNAL);
+				if (r < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					if (errno == EAGAIN || errno == EWOULDBLOCK)
+						break;
+					return false;
+				}
+				offset += r;
+			}
+			_out.erase(_out.begin(), _out.begin() + offset);
+			return true;
+		}
+
+		bool Connection::Read()
+		{
+			u8 buffer[4096];
+			while(true)
+			{
+				ssize_t r = recv(_fd, buffer, sizeof(buffer), 0);
+				if (r == 0)
+					return false;
+				if (r < 0)
+				{
+					if (errno == EINTR)
+						continue;
+					return errno == EAGAIN || errno == EWOULDBLOCK;
+				}
+				_in.insert(_in.end(), buffer, buffer + r);
+			}
+		}
+	}
+}
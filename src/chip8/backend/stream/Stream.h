@@ -0,0 +1,88 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <chip8/Audio.h>
+#include <chip8/types.h>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	class Framebuffer;
+
+	///wire format shared by StreamBackend and xomod-viewer
+	///every message is type byte, little-endian u16 payload size and payload
+	namespace stream
+	{
+		enum class Message : u8
+		{
+			///width, height, then changed rows: row index followed by run bytes covering the whole row
+			///run byte is (planes << 6) | (length - 1); rows not listed are unchanged, resolution change clears
+			Frame	= 1,
+			///on flag, then Audio::PatternSize bytes of XO-CHIP audio pattern
+			Buzzer	= 2,
+			///key index, pressed flag; viewer to server
+			Key		= 3,
+		};
+
+		static constexpr uint HeaderSize	= 3;
+		static constexpr uint MaxRun		= 64;
+
+		///"unix:<path>" or "[host:]port", host defaults to loopback; sockets are non-blocking
+		int Listen(const std::string &address);
+		int Connect(const std::string &address);
+
+		///appends rows of fb differing from previous (all rows if full) to payload and updates previous
+		///returns false if nothing changed
+		bool EncodeFrame(std::vector<u8> &payload, const Framebuffer &fb, u8 *previous, bool full);
+		///applies frame payload to fb, marks changed pixels dirty
+		void DecodeFrame(Framebuffer &fb, const u8 *payload, size_t size);
+
+		///buffered non-blocking socket, Send queues whole messages so partial writes never split framing
+		class Connection
+		{
+			int				_fd;
+			std::vector<u8>	_in, _out;
+
+		public:
+			explicit Connection(int fd): _fd(fd) { }
+			~Connection();
+
+			Connection(const Connection &) = delete;
+			Connection& operator = (const Connection &) = delete;
+
+			int GetFd() const
+			{ return _fd; }
+
+			size_t GetPending() const
+			{ return _out.size(); }
+
+			void Send(Message type, const u8 *payload, size_t size);
+			///writes as much as socket accepts, false on error
+			bool Flush();
+
+			///reads available data and calls handler(type, payload, size) per complete message, false on eof or error
+			template<typename Handler>
+			bool Receive(Handler handler)
+			{
+				bool open = Read();
+				size_t offset = 0;
+				while(_in.size() - offset >= HeaderSize)
+				{
+					size_t size = _in[offset + 1] | (_in[offset + 2] << 8);
+					if (_in.size() - offset < HeaderSize + size)
+						break;
+					handler(static_cast<Message>(_in[offset]), _in.data() + offset + HeaderSize, size);
+					offset += HeaderSize + size;
+				}
+				_in.erase(_in.begin(), _in.begin() + offset);
+				return open;
+			}
+
+		private:
+			bool Read();
+		};
+	}
+}
+
+#endif
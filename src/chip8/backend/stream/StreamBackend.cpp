@@ -0,0 +1,145 @@
+#include <chip8/backend/stream/StreamBackend.h>
+#include <algorithm>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace chip8
+{
+	StreamBackend::StreamBackend(Backend & backend, const std::string &address):
+		ProxyBackend(backend), _listen(stream::Listen(address)), _previous(), _w(0), _h(0), _keys(0), _audio(nullptr), _buzzer()
+	{ }
+
+	StreamBackend::~StreamBackend()
+	{ close(_listen); }
+
+	void StreamBackend::Accept()
+	{
+		while(true)
+		{
+			int fd = accept4(_listen, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				if (errno != EAGAIN && errno != EWOULDBLOCK)
+					fprintf(stderr, "stream: accept failed: %s\n", strerror(errno));
+				break;
+			}
+			_clients.emplace_back(new Client(fd));
+		}
+	}
+
+	void StreamBackend::OnMessage(Client &client, stream::Message type, const u8 *payload, size_t size)
+	{
+		if (type != stream::Message::Key || size < 2 || payload[0] >= 16)
+			return;
+		u16 mask = 1 << payload[0];
+		if (payload[1])
+			client.Keys |= mask;
+		else
+			client.Keys &= ~mask;
+	}
+
+	void StreamBackend::RemoveClosed()
+	{
+		_clients.erase(std::remove(_clients.begin(), _clients.end(), nullptr), _clients.end());
+		_keys = 0;
+		for(auto &client : _clients)
+			_keys |= client->Keys;
+	}
+
+	bool StreamBackend::Receive()
+	{
+		bool full = false;
+		for(auto &client : _clients)
+		{
+			auto &c = *client;
+			if (!c.Connection.Receive([this, &c](stream::Message type, const u8 *payload, size_t size) { OnMessage(c, type, payload, size); }))
+				client.reset();
+			else
+				full |= client->Full;
+		}
+		RemoveClosed();
+		return full;
+	}
+
+	void StreamBackend::PollInput(std::chrono::steady_clock::time_point time)
+	{
+		Receive();
+		_backend.PollInput(time);
+	}
+
+	bool StreamBackend::ProcessEvents(Framebuffer & fb)
+	{
+		Accept();
+		if (Receive())
+			fb.Invalidate(); //new or lagging viewer waits for a full frame even if nothing changes
+		return _backend.ProcessEvents(fb);
+	}
+
+	bool StreamBackend::Render(Framebuffer & fb)
+	{
+
+		bool resized = fb.GetWidth() != _w || fb.GetHeight() != _h;
+		_w = fb.GetWidth();
+		_h = fb.GetHeight();
+
+		//delta against last frame is shared by all clients in sync, others get full frame from shadow copy
+		_delta.clear();
+		bool changed = stream::EncodeFrame(_delta, fb, _previous.data(), resized);
+		_full.clear();
+
+		std::array<u8, 1 + Audio::PatternSize> buzzer = {};
+		if (_audio)
+		{
+			buzzer[0] = 1;
+			_audio->GetPattern(buzzer.data() + 1);
+		}
+		bool buzzerChanged = buzzer != _buzzer;
+		_buzzer = buzzer;
+
+		for(auto &client : _clients)
+		{
+			auto &connection = client->Connection;
+			if (connection.GetPending() > MaxPending)
+			{
+				client->Full = true;
+				connection.Flush();
+				continue;
+			}
+
+			if (client->Full)
+			{
+				if (_full.empty())
+					stream::EncodeFrame(_full, fb, _previous.data(), true);
+				connection.Send(stream::Message::Frame, _full.data(), _full.size());
+				connection.Send(stream::Message::Buzzer, _buzzer.data(), _buzzer.size());
+				client->Full = false;
+			}
+			else
+			{
+				if (changed)
+					connection.Send(stream::Message::Frame, _delta.data(), _delta.size());
+				if (buzzerChanged)
+					connection.Send(stream::Message::Buzzer, _buzzer.data(), _buzzer.size());
+			}
+			if (!connection.Flush())
+				client.reset();
+		}
+		RemoveClosed();
+
+		return _backend.Render(fb);
+	}
+
+	bool StreamBackend::GetKeyState(u8 index)
+	{ return (index < 16 && (_keys & (1 << index))) || _backend.GetKeyState(index); }
+
+	void StreamBackend::SetAudio(Audio *audio)
+	{
+		_audio = audio;
+		_backend.SetAudio(audio);
+	}
+}
@@ -0,0 +1,61 @@
+#ifndef STREAMBACKEND_H
+#define STREAMBACKEND_H
+
+#include <chip8/backend/ProxyBackend.h>
+#include <chip8/backend/stream/Stream.h>
+#include <chip8/Framebuffer.h>
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace chip8
+{
+	///publishes framebuffer deltas and buzzer state to viewers connected to a local socket, keys pressed
+	///in any viewer are merged with keys of the wrapped backend
+	class StreamBackend : public ProxyBackend
+	{
+		static constexpr size_t MaxPending = 64 * 1024; //slow viewer skips frames and gets full frame later
+
+		struct Client
+		{
+			stream::Connection	Connection;
+			bool				Full;
+			u16					Keys; //held in this viewer, gone with its connection
+
+			explicit Client(int fd): Connection(fd), Full(true), Keys(0) { }
+		};
+
+		int										_listen;
+		std::vector<std::unique_ptr<Client>>	_clients;
+		std::array<u8, Framebuffer::MaxSize>	_previous;
+		u8										_w, _h;
+		u16										_keys; //all viewers' keys combined
+		Audio *									_audio;
+		std::array<u8, 1 + Audio::PatternSize>	_buzzer; //last sent buzzer message
+
+		std::vector<u8>							_delta, _full;
+
+		void Accept();
+		void OnMessage(Client &client, stream::Message type, const u8 *payload, size_t size);
+		///drops closed connections and combines keys of remaining viewers
+		void RemoveClosed();
+		///reads viewer keys and drops closed connections, true if some viewer waits for a full frame
+		bool Receive();
+
+	public:
+		StreamBackend(Backend & backend, const std::string &address);
+		~StreamBackend();
+
+		StreamBackend(const StreamBackend &) = delete;
+		StreamBackend& operator = (const StreamBackend &) = delete;
+
+		void PollInput(std::chrono::steady_clock::time_point time) override;
+		bool ProcessEvents(Framebuffer & fb) override;
+		bool Render(Framebuffer & fb) override;
+		bool GetKeyState(u8 index) override;
+		void SetAudio(Audio *audio) override;
+	};
+}
+
+#endif
@@ -1,8 +1,16 @@
 #include <chip8/backend/terminal/TerminalBackend.h>
 #include <chip8/Framebuffer.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <errno.h>
+#include <poll.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
+#include <array>
+#include <climits>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include <tuple>
 
@@ -73,8 +81,112 @@ namespace chip8
 		};
 	}
 
-	bool TerminalBackend::GetKeyState(u8 index)
-	{ return false; }
+	TerminalBackend::TerminalBackend(): _stop(eventfd(0, EFD_CLOEXEC)), _raw(false), _saved(), _cols(0), _rows(0)
+	{
+		if (_stop < 0)
+			throw std::runtime_error(std::string("eventfd: ") + strerror(errno));
+
+		if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &_saved) == 0)
+		{
+			struct termios raw = _saved;
+			raw.c_lflag &= ~(ICANON | ECHO); //keep ISIG, ctrl-c still quits
+			raw.c_cc[VMIN] = 1;
+			raw.c_cc[VTIME] = 0;
+			_raw = tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0;
+		}
+		_reader = std::thread(&TerminalBackend::Read, this);
+	}
+
+	TerminalBackend::~TerminalBackend()
+	{
+		u64 one = 1;
+		if (write(_stop, &one, sizeof(one)) != sizeof(one))
+			perror("write");
+		_reader.join();
+		close(_stop);
+		if (_raw)
+			tcsetattr(STDIN_FILENO, TCSANOW, &_saved);
+	}
+
+	void TerminalBackend::Read()
+	{
+		using clock = KeyQueue::clock;
+		static const char layout[] = "x123qweasdzc4rfv"; //keypad value is the index, same keys as SDL2 backend
+
+		std::array<clock::time_point, 16> release = {}; //keys held until then, epoch if released
+		pollfd fds[2] = { { STDIN_FILENO, POLLIN, 0 }, { _stop, POLLIN, 0 } };
+		while(true)
+		{
+			auto now = clock::now();
+			int timeout = -1;
+			for(u8 key = 0; key < 16; ++key)
+			{
+				if (release[key] == clock::time_point())
+					continue;
+				if (release[key] <= now)
+				{
+					_keys.Push(key, false, release[key]);
+					release[key] = clock::time_point();
+					continue;
+				}
+				auto ms = std::chrono::ceil<std::chrono::milliseconds>(release[key] - now).count();
+				timeout = timeout < 0? ms: std::min<int>(timeout, ms);
+			}
+
+			if (poll(fds, 2, timeout) < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				perror("poll");
+				break;
+			}
+			if (fds[1].revents)
+				break;
+			if (!fds[0].revents)
+				continue;
+
+			char buffer[64];
+			ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+			if (n <= 0)
+			{
+				if (n < 0 && errno == EINTR)
+					continue;
+				fds[0].fd = -1; //eof, only pending releases left
+				continue;
+			}
+
+			now = clock::now();
+			for(ssize_t i = 0; i < n; ++i)
+			{
+				auto pos = strchr(layout, tolower(static_cast<unsigned char>(buffer[i])));
+				if (!pos || !*pos)
+					continue;
+				auto key = pos - layout;
+				if (release[key] == clock::time_point())
+				{
+					_keys.Push(key, true, now);
+					release[key] = now + FirstHold;
+				}
+				else
+					release[key] = now + RepeatHold;
+			}
+		}
+	}
+
+	bool TerminalBackend::ProcessEvents(Framebuffer & fb)
+	{
+		_keys.Apply(KeyQueue::clock::now());
+
+		//terminal resize needs full redraw
+		struct winsize w;
+		if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &w) == 0 && (w.ws_col != _cols || w.ws_row != _rows))
+		{
+			_cols = w.ws_col;
+			_rows = w.ws_row;
+			fb.Invalidate();
+		}
+		return true;
+	}
 
 	bool TerminalBackend::Render(Framebuffer & fb)
 	{
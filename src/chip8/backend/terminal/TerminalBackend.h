@@ -2,14 +2,41 @@
 #define CONSOLEBACKEND_H
 
 #include <chip8/Backend.h>
+#include <chip8/KeyQueue.h>
+#include <termios.h>
+#include <thread>
 
 namespace chip8
 {
+	///keys are read from stdin by a thread stamping each key press, terminals report no releases:
+	///a key counts as held until the terminal stops repeating it
 	class TerminalBackend : public Backend
 	{
+		static constexpr std::chrono::milliseconds FirstHold { 500 };	//covers terminal key repeat delay
+		static constexpr std::chrono::milliseconds RepeatHold { 100 };
+
+		KeyQueue		_keys;
+		int				_stop;		//eventfd waking the reader
+		bool			_raw;		//stdin is a terminal switched out of canonical mode
+		struct termios	_saved;
+		int				_cols, _rows;
+		std::thread		_reader;
+
+		void Read();
+
 	public:
+		TerminalBackend();
+		~TerminalBackend();
+
+		TerminalBackend(const TerminalBackend &) = delete;
+		TerminalBackend& operator = (const TerminalBackend &) = delete;
+
+		void PollInput(KeyQueue::clock::time_point time) override
+		{ _keys.Apply(time); }
+		bool ProcessEvents(Framebuffer & fb) override;
 		bool Render(Framebuffer & fb) override;
-		bool GetKeyState(u8 index) override;
+		bool GetKeyState(u8 index) override
+		{ return _keys.Get(index); }
 		void SetAudio(Audio *audio) override { }
 
 	private:
@@ -0,0 +1,177 @@
+#include <libxomod/xomod.h>
+#include <chip8/Backend.h>
+#include <chip8/Chip8.h>
+#include <chip8/Config.h>
+#include <chip8/Rom.h>
+#include <array>
+#include <string>
+#include <vector>
+
+using namespace chip8;
+
+namespace
+{
+	///keys come from caller, rendering is done by caller reading framebuffer
+	class ApiBackend : public Backend
+	{
+		u16		_keys;
+		Audio *	_audio;
+
+	public:
+		ApiBackend(): _keys(0), _audio(nullptr) { }
+
+		void SetKeys(u16 keys)
+		{ _keys = keys; }
+
+		bool IsBuzzing() const
+		{ return _audio != nullptr; }
+
+		bool Render(Framebuffer & fb) override { return true; }
+		bool GetKeyState(u8 index) override { return index < 16 && (_keys & (1 << index)); }
+		void SetAudio(Audio *audio) override { _audio = audio; }
+	};
+}
+
+struct xomod
+{
+	Config				config;
+	ApiBackend			backend;
+	Chip8				chip;
+	std::vector<u8>		state;
+	std::string			error;
+	std::string			options; //ini text of every accepted xomod_set_option, applied again over rom ini
+	mutable std::array<u8, Framebuffer::MaxSize> pixels; //plane bits only, internal dirty bit stripped
+
+	xomod(): chip(config, backend)
+	{
+		config.PersistFlags = false;
+		chip.SetHaltOnFault(true);
+	}
+
+	template<typename Func>
+	int Call(Func func)
+	{
+		try
+		{
+			func();
+			return 0;
+		}
+		catch(const std::exception &ex)
+		{
+			error = ex.what();
+			return -1;
+		}
+	}
+};
+
+extern "C"
+{
+
+uint32_t xomod_api_version(void)
+{ return XOMOD_API_VERSION; }
+
+xomod *xomod_create(void)
+{
+	try
+	{ return new xomod(); }
+	catch(...)
+	{ return nullptr; }
+}
+
+void xomod_destroy(xomod *x)
+{ delete x; }
+
+const char *xomod_get_error(const xomod *x)
+{ return x->error.c_str(); }
+
+int xomod_set_option(xomod *x, const char *section, const char *name, const char *value)
+{
+	return x->Call([&]() {
+		auto option = std::string("[") + section + "]\n" + name + " = " + value + "\n";
+		x->config.Parse(option);
+		x->options += option;
+	});
+}
+
+void xomod_set_seed(xomod *x, uint32_t seed)
+{ x->chip.Seed(seed); }
+
+int xomod_load_rom(xomod *x, const uint8_t *data, size_t size)
+{
+	return x->Call([&]() {
+		x->chip.Load(data, size);
+		x->chip.Reset();
+	});
+}
+
+int xomod_load_file(xomod *x, const char *path)
+{
+	return x->Call([&]() {
+		auto rom = LoadRom(path);
+		//ini only sets keys it mentions, nothing may carry over from the previous rom
+		x->config.Core = Config::CoreConfig();
+		x->config.Quirks = Config::QuirksConfig();
+		x->config.Palette = Config::PaletteConfig();
+		x->config.LoadRomConfig(path);
+		x->config.Parse(x->options);
+		x->chip.Load(rom.data(), rom.size());
+		x->chip.Reset();
+	});
+}
+
+void xomod_reset(xomod *x)
+{ x->chip.Reset(); }
+
+void xomod_set_keys(xomod *x, uint16_t keys)
+{ x->backend.SetKeys(keys); }
+
+uint32_t xomod_run(xomod *x, uint32_t instructions)
+{ return x->chip.RunCycles(instructions); }
+
+int xomod_run_frame(xomod *x)
+{ return x->chip.AdvanceFrame()? 1: 0; }
+
+int xomod_is_running(const xomod *x)
+{ return x->chip.IsRunning()? 1: 0; }
+
+enum xomod_fault xomod_get_fault(const xomod *x)
+{ return static_cast<xomod_fault>(x->chip.GetFault()); }
+
+uint64_t xomod_get_instruction_count(const xomod *x)
+{ return x->chip.GetInstructionCount(); }
+
+int xomod_get_buzzer(const xomod *x)
+{ return x->backend.IsBuzzing()? 1: 0; }
+
+const uint8_t *xomod_get_framebuffer(const xomod *x, int *width, int *height)
+{
+	auto &fb = x->chip.GetFramebuffer();
+	if (width)
+		*width = fb.GetWidth();
+	if (height)
+		*height = fb.GetHeight();
+	auto data = fb.GetData();
+	size_t size = fb.GetWidth() * fb.GetHeight();
+	for(size_t i = 0; i < size; ++i)
+		x->pixels[i] = data[i] & 0x03;
+	return x->pixels.data();
+}
+
+size_t xomod_save_state(xomod *x, void *buffer, size_t size)
+{
+	x->state.clear();
+	if (x->Call([&]() { x->chip.SaveState(x->state); }) != 0)
+		return 0;
+	if (buffer && x->state.size() <= size)
+		std::copy(x->state.begin(), x->state.end(), static_cast<u8 *>(buffer));
+	return x->state.size();
+}
+
+int xomod_load_state(xomod *x, const void *buffer, size_t size)
+{
+	return x->Call([&]() {
+		x->chip.LoadState(static_cast<const u8 *>(buffer), size);
+	});
+}
+
+}
@@ -0,0 +1,80 @@
+#ifndef XOMOD_H
+#define XOMOD_H
+
+/*
+ * Embeddable CHIP-8/SuperCHIP/XO-CHIP interpreter.
+ * Every call on one instance must come from one thread at a time, separate instances are independent.
+ * Functions returning int return 0 on success and -1 on error, see xomod_get_error.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#	define XOMOD_API __declspec(dllexport)
+#else
+#	define XOMOD_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XOMOD_API_VERSION 1
+
+typedef struct xomod xomod;
+
+enum xomod_fault
+{
+	XOMOD_FAULT_NONE,
+	XOMOD_FAULT_INVALID_INSTRUCTION,
+	XOMOD_FAULT_STACK_OVERFLOW,
+	XOMOD_FAULT_STACK_UNDERFLOW
+};
+
+XOMOD_API uint32_t xomod_api_version(void);
+
+XOMOD_API xomod *xomod_create(void);
+XOMOD_API void xomod_destroy(xomod *x);
+
+/* message of the last failed call, valid until the next call on this instance */
+XOMOD_API const char *xomod_get_error(const xomod *x);
+
+/* ini-style setting, e.g. ("core", "speed", "1000") or ("quirks", "shift", "on"), kept over later xomod_load_file calls */
+XOMOD_API int xomod_set_option(xomod *x, const char *section, const char *name, const char *value);
+XOMOD_API void xomod_set_seed(xomod *x, uint32_t seed);
+
+/* loads rom image and resets machine */
+XOMOD_API int xomod_load_rom(xomod *x, const uint8_t *data, size_t size);
+/* loads .ch8 binary or .8o Octo source, resets machine
+   settings start from defaults, then sibling .ini, then options set so far with xomod_set_option */
+XOMOD_API int xomod_load_file(xomod *x, const char *path);
+XOMOD_API void xomod_reset(xomod *x);
+
+/* bit n set means key n is held */
+XOMOD_API void xomod_set_keys(xomod *x, uint16_t keys);
+
+/* runs up to n instructions without advancing timers, returns number executed */
+XOMOD_API uint32_t xomod_run(xomod *x, uint32_t instructions);
+/* runs one 60Hz frame of core.speed instructions and advances timers, returns 0 once machine halted */
+XOMOD_API int xomod_run_frame(xomod *x);
+
+XOMOD_API int xomod_is_running(const xomod *x);
+XOMOD_API enum xomod_fault xomod_get_fault(const xomod *x);
+XOMOD_API uint64_t xomod_get_instruction_count(const xomod *x);
+/* 1 while sound timer is active */
+XOMOD_API int xomod_get_buzzer(const xomod *x);
+
+/* row-major width * height pixels with values 0-3, bit 0 and 1 are planes, copy valid until the next call of this function */
+XOMOD_API const uint8_t *xomod_get_framebuffer(const xomod *x, int *width, int *height);
+
+/* writes state snapshot if it fits into size bytes, always returns size required, 0 on error */
+XOMOD_API size_t xomod_save_state(xomod *x, void *buffer, size_t size);
+/* restores snapshot taken with the same rom loaded */
+XOMOD_API int xomod_load_state(xomod *x, const void *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
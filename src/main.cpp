@@ -1,55 +1,289 @@
 #include <chip8/Chip8.h>
 #include <chip8/backend/terminal/TerminalBackend.h>
 #include <chip8/backend/sdl2/SDL2Backend.h>
-#include <chip8/File.h>
+#include <chip8/backend/null/NullBackend.h>
+#include <chip8/backend/movie/MovieBackend.h>
+#include <chip8/backend/shm/ShmBackend.h>
+#include <chip8/backend/stream/StreamBackend.h>
 #include <chip8/Config.h>
+#include <chip8/Coverage.h>
+#include <chip8/Debugger.h>
+#include <chip8/File.h>
+#include <chip8/Hash.h>
+#include <chip8/Metrics.h>
+#include <chip8/Movie.h>
+#include <chip8/Netplay.h>
+#include <chip8/Profiler.h>
+#include <chip8/Rom.h>
+#include <chip8/Timeline.h>
+#include <chip8/RomDatabase.h>
+#include <chip8/Tracer.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdlib.h>
+#include <thread>
 
 using namespace chip8;
 
+namespace
+{
+	void Usage()
+	{
+		std::cerr << "usage: [options] <rom file or .8o source>\n"
+			"\t--seed <n>\t\tdeterministic run with the given random seed\n"
+			"\t--record <movie>\trecord seed and input into movie file\n"
+			"\t--replay <movie>\treplay seed and input from movie file\n"
+			"\t--headless\t\tno video, audio or input\n"
+			"\t--turbo\t\t\tdo not limit emulation to 60 frames per second\n"
+			"\t--frames <n>\t\tstop after n frames\n"
+			"\t--profile <prefix>\twrite hot spot report and folded stacks on exit\n"
+			"\t--trace <file>\t\twrite binary instruction trace, decode with xomod-trace\n"
+			"\t--debug\t\t\tstart paused in interactive debugger on stdin\n"
+			"\t--coverage <prefix>\twrite code and data coverage map on exit\n"
+			"\t--no-static\t\tinterpret even if rom was recompiled into executable\n"
+			"\t--romdb <file>\t\trom settings database (default ~/.local/share/xomod/romdb.bin)\n"
+			"\t--stream <address>\tpublish frames to xomod-viewer on unix:<path> or [host:]port\n"
+			"\t--shm <name>\t\tpublish frames and key state in shared memory segment /<name>\n"
+			"\t--netplay <[host:]port>\trollback netplay on local udp port with --peer\n"
+			"\t--peer <host:port>\tnetplay peer address\n"
+			"\t--metrics <file>\tdump counters and histograms every second, json if file ends with .json, prometheus text otherwise\n"
+			"\t--timeline <file>\twrite frame, render, audio and file i/o zones as chrome trace json on exit\n"
+			"\t--auto-speed\t\ttune instructions per frame for roms waiting on delay timer\n"
+			"\t--save-speed\t\tauto speed and write learned speed into rom ini on exit\n";
+	}
+}
+
 int main(int argc, char **argv)
 {
-	if (argc < 2)
+	std::string romFile, recordFile, replayFile, profilePrefix, traceFile, coveragePrefix, romDbFile, streamAddress, shmName, netplayAddress, peerAddress, metricsFile, timelineFile;
+	bool headless = false, turbo = false, seeded = false, debug = false, noStatic = false, autoSpeed = false, saveSpeed = false;
+	u32 seed = 0;
+	unsigned long frames = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--seed" && hasValue)
+		{
+			seed = strtoul(argv[++i], nullptr, 0);
+			seeded = true;
+		}
+		else if (arg == "--record" && hasValue)
+			recordFile = argv[++i];
+		else if (arg == "--replay" && hasValue)
+			replayFile = argv[++i];
+		else if (arg == "--frames" && hasValue)
+			frames = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--profile" && hasValue)
+			profilePrefix = argv[++i];
+		else if (arg == "--trace" && hasValue)
+			traceFile = argv[++i];
+		else if (arg == "--coverage" && hasValue)
+			coveragePrefix = argv[++i];
+		else if (arg == "--romdb" && hasValue)
+			romDbFile = argv[++i];
+		else if (arg == "--stream" && hasValue)
+			streamAddress = argv[++i];
+		else if (arg == "--shm" && hasValue)
+			shmName = argv[++i];
+		else if (arg == "--netplay" && hasValue)
+			netplayAddress = argv[++i];
+		else if (arg == "--peer" && hasValue)
+			peerAddress = argv[++i];
+		else if (arg == "--metrics" && hasValue)
+			metricsFile = argv[++i];
+		else if (arg == "--timeline" && hasValue)
+			timelineFile = argv[++i];
+		else if (arg == "--auto-speed")
+			autoSpeed = true;
+		else if (arg == "--save-speed")
+			autoSpeed = saveSpeed = true;
+		else if (arg == "--no-static")
+			noStatic = true;
+		else if (arg == "--debug")
+			debug = true;
+		else if (arg == "--headless")
+			headless = true;
+		else if (arg == "--turbo")
+			turbo = true;
+		else if (arg.empty() || arg[0] == '-' || !romFile.empty())
+		{
+			Usage();
+			return 1;
+		}
+		else
+			romFile = arg;
+	}
+
+	if (romFile.empty() || netplayAddress.empty() != peerAddress.empty() ||
+		(!netplayAddress.empty() && (!recordFile.empty() || !replayFile.empty())))
 	{
-		std::cerr << "usage: <rom file>" << std::endl;
+		Usage();
 		return 1;
 	}
 
+	Movie movie;
+	if (!replayFile.empty())
+	{
+		movie.Load(replayFile);
+		seed = movie.GetSeed();
+		seeded = true;
+	}
+	else if (!recordFile.empty())
+	{
+		if (!seeded)
+			seed = std::random_device()();
+		movie.SetSeed(seed);
+		seeded = true;
+	}
+
+	if (!timelineFile.empty())
+	{
+		Timeline::SetThreadName("main");
+		Timeline::Enable();
+	}
+
+	std::unique_ptr<MetricsWriter> metrics;
+	if (!metricsFile.empty())
+		metrics.reset(new MetricsWriter(metricsFile));
+
 	//TerminalBackend backend;
 	Config config;
-	SDL2Backend backend(config);
-	Chip8 chip(config, backend);
+	std::unique_ptr<Backend> device;
+	if (headless)
+		device.reset(new NullBackend());
+	else
+		device.reset(new SDL2Backend(config));
+
+	//movie records keys coming from viewers and shared memory too
+	std::unique_ptr<Backend> streamer;
+	if (!streamAddress.empty())
+		streamer.reset(new StreamBackend(*device, streamAddress));
+	std::unique_ptr<Backend> shm;
+	if (!shmName.empty())
+		shm.reset(new ShmBackend(streamer? *streamer: *device, shmName));
+	Backend &input = shm? *shm: streamer? *streamer: *device;
 
-	std::string romFile = argv[1];
+	std::unique_ptr<Backend> proxy;
+	if (!replayFile.empty())
+		proxy.reset(new MoviePlayer(input, movie));
+	else if (!recordFile.empty())
+		proxy.reset(new MovieRecorder(input, movie));
+	else if (!netplayAddress.empty())
 	{
-		File rom(romFile, "rb");
-		auto buffer = rom.ReadAll<std::vector<u8>>();
+		proxy.reset(new NetplayBackend(input));
+		config.PersistFlags = false;
+	}
+
+	Chip8 chip(config, proxy? *proxy: input);
+	if (seeded)
+	{
+		chip.Seed(seed);
+		config.PersistFlags = false;
+	}
+
+	std::unique_ptr<Profiler> profiler;
+	if (!profilePrefix.empty())
+	{
+		profiler.reset(new Profiler());
+		chip.SetProfiler(profiler.get());
+	}
+
+	std::unique_ptr<Tracer> tracer;
+	if (!traceFile.empty())
+	{
+		tracer.reset(new Tracer(traceFile));
+		chip.SetTracer(tracer.get());
+	}
+
+	std::unique_ptr<Coverage> coverage;
+	if (!coveragePrefix.empty())
+	{
+		coverage.reset(new Coverage());
+		chip.SetCoverage(coverage.get());
+	}
+
+	std::unique_ptr<Debugger> debugger;
+	if (debug)
+	{
+		debugger.reset(new Debugger(chip));
+		debugger->Pause();
+		chip.SetDebugger(debugger.get());
+		Debugger::CatchInterrupt();
+	}
+
+	u64 romHash;
+	{
+		auto buffer = LoadRom(romFile);
 		chip.Load(buffer.data(), buffer.size());
+		romHash = Hash(buffer.data(), buffer.size());
+
+		//database settings first, sibling ini overrides them
+		if (romDbFile.empty())
+			romDbFile = RomDatabase::GetDefaultPath();
+		if (File::Exists(romDbFile))
+		{
+			RomDatabase db(romDbFile);
+			if (auto record = db.Find(RomDatabase::HashRom(buffer.data(), buffer.size())))
+				RomDatabase::Apply(*record, config);
+		}
 	}
-	auto dotPos = romFile.rfind('.');
+	config.LoadRomConfig(romFile);
+	if (turbo)
+		config.Core.Turbo = true;
+	if (noStatic)
+		config.Core.Static = false;
+	if (autoSpeed)
+		config.Core.AutoSpeed = true;
 
-	std::string prefix;
-	if (dotPos != romFile.npos)
-		prefix = romFile.substr(0, dotPos);
-	else
-		prefix = romFile;
+	if (!netplayAddress.empty())
 	{
-		auto slash = prefix.rfind('/');
-		if (slash == prefix.npos)
-			slash = 0;
-		else
-			++slash;
-		config.RomName = prefix.substr(slash);
+		//tuner state is not part of snapshots, rollbacks would desync peers
+		config.Core.AutoSpeed = false;
+		Netplay netplay(chip, static_cast<NetplayBackend &>(*proxy), netplayAddress, peerAddress);
+		std::cerr << "waiting for " << peerAddress << "\n";
+		netplay.Connect(romHash, seeded? seed: std::random_device()());
+
+		//timing as in Chip8::Tick, netplay decides which frames are simulated
+		using clock = std::chrono::steady_clock;
+		auto next = clock::now();
+		for(unsigned long frame = 0; (!frames || frame < frames) && netplay.Step() && chip.Render(); ++frame)
+		{
+			next += std::chrono::microseconds(Chip8::TimerPeriodMs);
+			std::this_thread::sleep_until(next);
+		}
+		auto &stats = netplay.GetStats();
+		std::cerr << "netplay: " << netplay.GetFrame() << " frames, " << stats.Rollbacks << " rollbacks, "
+			<< stats.Resimulated << " frames resimulated, " << stats.Stalls << " stalls\n";
 	}
+	else
+		for(unsigned long frame = 0; (!frames || frame < frames) && chip.Tick(); ++frame);
 
-	std::string configFile = prefix + ".ini";
-	if (File::Exists(configFile))
+	auto &tuner = chip.GetSpeedTuner();
+	if (saveSpeed)
 	{
-		File cfg(configFile, "rt");
-		auto data = cfg.ReadAll<std::vector<char>>();
-		std::string text(data.begin(), data.end());
-		config.Parse(text);
+		if (tuner.IsConfident(config.Core.Speed))
+		{
+			auto speed = std::to_string(tuner.GetLearnedSpeed());
+			config.SaveRomValue("core", "speed", speed);
+			std::cerr << "saved speed " << speed << "\n";
+		}
+		else if (tuner.IsTuned())
+			std::cerr << "speed " << tuner.GetLearnedSpeed() << " learned without enough load, not saved\n";
+		else
+			std::cerr << "rom does not wait on delay timer, speed not saved\n";
 	}
 
-	while(chip.Tick());
+	if (!recordFile.empty())
+		movie.Save(recordFile);
+	if (profiler)
+		profiler->Save(profilePrefix);
+	if (coverage)
+		coverage->Save(coveragePrefix);
+	if (!timelineFile.empty())
+		Timeline::Save(timelineFile);
 	return 0;
 }
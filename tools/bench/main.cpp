@@ -0,0 +1,242 @@
+#include <chip8/Chip8.h>
+#include <chip8/Config.h>
+#include <chip8/File.h>
+#include <chip8/Framebuffer.h>
+#include <chip8/Movie.h>
+#include <chip8/backend/movie/MovieBackend.h>
+#include <chip8/backend/null/NullBackend.h>
+#include <chip8/backend/sdl2/SDL2Backend.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdlib.h>
+
+using namespace chip8;
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	double Elapsed(clock::time_point started)
+	{ return std::chrono::duration<double, std::nano>(clock::now() - started).count(); }
+
+	///measures time spent in backend rendering
+	class TimingBackend : public ProxyBackend
+	{
+		double _renderNs;
+
+	public:
+		TimingBackend(Backend & backend): ProxyBackend(backend), _renderNs(0) { }
+
+		double GetRenderTime() const
+		{ return _renderNs; }
+
+		bool Render(Framebuffer & fb) override
+		{
+			auto started = clock::now();
+			bool running = _backend.Render(fb);
+			_renderNs += Elapsed(started);
+			return running;
+		}
+	};
+
+	struct RomResult
+	{
+		std::string	Name;
+		uint		Frames;
+		u64			Instructions;
+		double		ExecNs;
+		double		RenderNs;
+		std::string	Error;
+	};
+
+	std::string Quote(const std::string &value)
+	{
+		std::string r = "\"";
+		for(char c : value)
+		{
+			if (c == '"' || c == '\\')
+				r += '\\';
+			if (static_cast<u8>(c) >= 0x20)
+				r += c;
+		}
+		return r + "\"";
+	}
+
+	RomResult RunRom(const std::string &romFile, Backend & device, uint frames, u32 seed)
+	{
+		RomResult result = { };
+		Config config;
+		config.LoadRomConfig(romFile);
+		config.PersistFlags = false;
+		config.Core.Turbo = true;
+		result.Name = config.RomName;
+
+		Movie movie(seed);
+		std::string movieFile = romFile.substr(0, romFile.rfind('.')) + ".movie";
+		if (File::Exists(movieFile))
+			movie.Load(movieFile);
+		while(movie.GetSize() <= frames)
+			movie.Append(0);
+
+		TimingBackend timing(device);
+		MoviePlayer player(timing, movie);
+		Chip8 chip(config, player);
+		chip.Seed(movie.GetSeed());
+		{
+			File rom(romFile, "rb");
+			auto buffer = rom.ReadAll<std::vector<u8>>();
+			chip.Load(buffer.data(), buffer.size());
+		}
+
+		auto started = clock::now();
+		try
+		{
+			while(result.Frames < frames && chip.Tick())
+				++result.Frames;
+		}
+		catch(const std::exception &ex)
+		{ result.Error = ex.what(); }
+
+		result.RenderNs = timing.GetRenderTime();
+		result.ExecNs = Elapsed(started) - result.RenderNs;
+		result.Instructions = chip.GetInstructionCount();
+		return result;
+	}
+
+	template<typename Func>
+	double NsPerOp(uint n, Func && func)
+	{
+		auto started = clock::now();
+		for(uint i = 0; i < n; ++i)
+			func(i);
+		return Elapsed(started) / n;
+	}
+
+	void FramebufferBench(std::ostream &os)
+	{
+		static constexpr uint N = 1000000;
+		static constexpr uint ScrollN = 100000;
+		Framebuffer fb;
+		volatile bool sink = false;
+
+		fb.SetResolution(64, 32);
+		double lores = NsPerOp(N, [&](uint i) { sink = fb.Write(i & 1, i * 7, i * 13, i * 0x9d); });
+		fb.SetResolution(128, 64);
+		double hires = NsPerOp(N, [&](uint i) { sink = fb.Write(i & 1, i * 7, i * 13, i * 0x9d); });
+
+		double down		= NsPerOp(ScrollN, [&](uint) { fb.Scroll(0, 4); });
+		double up		= NsPerOp(ScrollN, [&](uint) { fb.Scroll(0, -4); });
+		double right	= NsPerOp(ScrollN, [&](uint) { fb.Scroll(4, 0); });
+		double left		= NsPerOp(ScrollN, [&](uint) { fb.Scroll(-4, 0); });
+		(void)sink;
+
+		os << "\t\"framebuffer\": {\n"
+			<< "\t\t\"write_lores_ns\": " << lores << ",\n"
+			<< "\t\t\"write_hires_ns\": " << hires << ",\n"
+			<< "\t\t\"scroll_down_ns\": " << down << ",\n"
+			<< "\t\t\"scroll_up_ns\": " << up << ",\n"
+			<< "\t\t\"scroll_right_ns\": " << right << ",\n"
+			<< "\t\t\"scroll_left_ns\": " << left << "\n"
+			<< "\t},\n";
+	}
+
+	void Usage()
+	{
+		std::cerr << "usage: [options] [rom files...]\n"
+			"\t--games <dir>\t\tbenchmark every .ch8 in directory (default games)\n"
+			"\t--frames <n>\t\tframes per rom (default 600)\n"
+			"\t--seed <n>\t\trandom seed if rom has no movie (default 0)\n"
+			"\t--backend <name>\tnull or sdl2 (default null)\n"
+			"\t--output <file>\t\twrite json report into file instead of stdout\n"
+			"recorded input is replayed from <rom>.movie when present\n";
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string gamesDir = "games", backendName = "null", outputFile;
+	std::vector<std::string> roms;
+	uint frames = 600;
+	u32 seed = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--games" && hasValue)
+			gamesDir = argv[++i];
+		else if (arg == "--frames" && hasValue)
+			frames = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--seed" && hasValue)
+			seed = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--backend" && hasValue)
+			backendName = argv[++i];
+		else if (arg == "--output" && hasValue)
+			outputFile = argv[++i];
+		else if (arg.empty() || arg[0] == '-')
+		{
+			Usage();
+			return 1;
+		}
+		else
+			roms.push_back(arg);
+	}
+
+	if (roms.empty())
+		roms = File::List(gamesDir, ".ch8");
+
+	Config deviceConfig;
+	std::unique_ptr<Backend> device;
+	if (backendName == "null")
+		device.reset(new NullBackend());
+	else if (backendName == "sdl2")
+		device.reset(new SDL2Backend(deviceConfig));
+	else
+	{
+		Usage();
+		return 1;
+	}
+
+	std::stringstream os;
+	os << "{\n"
+		<< "\t\"backend\": " << Quote(backendName) << ",\n"
+		<< "\t\"frames\": " << frames << ",\n";
+
+	FramebufferBench(os);
+
+	u64 totalInstructions = 0;
+	double totalExecNs = 0;
+	os << "\t\"roms\": [\n";
+	for(size_t i = 0; i < roms.size(); ++i)
+	{
+		auto r = RunRom(roms[i], *device, frames, seed);
+		totalInstructions += r.Instructions;
+		totalExecNs += r.ExecNs;
+		std::cerr << r.Name << ": " << r.Instructions << " instructions in " << r.Frames << " frames\n";
+
+		os << "\t\t{ \"name\": " << Quote(r.Name)
+			<< ", \"frames\": " << r.Frames
+			<< ", \"instructions\": " << r.Instructions
+			<< ", \"instructions_per_sec\": " << (r.ExecNs > 0? r.Instructions * 1e9 / r.ExecNs: 0)
+			<< ", \"step_ns\": " << (r.Instructions? r.ExecNs / r.Instructions: 0)
+			<< ", \"render_ns_per_frame\": " << (r.Frames? r.RenderNs / r.Frames: 0);
+		if (!r.Error.empty())
+			os << ", \"error\": " << Quote(r.Error);
+		os << " }" << (i + 1 < roms.size()? ",": "") << "\n";
+	}
+	os << "\t],\n"
+		<< "\t\"instructions_per_sec\": " << (totalExecNs > 0? totalInstructions * 1e9 / totalExecNs: 0) << "\n"
+		<< "}\n";
+
+	if (outputFile.empty())
+		std::cout << os.str();
+	else
+	{
+		File file(outputFile, "wt");
+		auto text = os.str();
+		file.Write(text.data(), text.size());
+	}
+	return 0;
+}
@@ -0,0 +1,178 @@
+#include <chip8/Chip8.h>
+#include <chip8/Config.h>
+#include <chip8/File.h>
+#include <chip8/Movie.h>
+#include <chip8/String.h>
+#include <chip8/backend/movie/MovieBackend.h>
+#include <chip8/backend/null/NullBackend.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <stdlib.h>
+
+using namespace chip8;
+
+namespace
+{
+	const std::vector<uint> CheckFrames = { 60, 300, 900, 1800 };
+
+	///holds a random key for a few frames every second, starting from the first frame
+	void ScriptInput(Movie & movie, uint frames)
+	{
+		std::mt19937 gen(movie.GetSeed());
+		std::uniform_int_distribution<u16> key(0, 15);
+		while(movie.GetSize() <= frames)
+		{
+			u16 mask = 1 << key(gen);
+			for(uint i = 0; i < 8; ++i)
+				movie.Append(mask);
+			for(uint i = 0; i < 52; ++i)
+				movie.Append(0);
+		}
+	}
+
+	///one line per checked frame: "<rom> <frame> <hash>"
+	std::string RunRom(const std::string &romFile, u32 seed)
+	{
+		Config config;
+		config.LoadRomConfig(romFile);
+		config.PersistFlags = false;
+		config.Core.Turbo = true;
+
+		uint frames = CheckFrames.back();
+		Movie movie(seed);
+		std::string movieFile = romFile.substr(0, romFile.rfind('.')) + ".movie";
+		if (File::Exists(movieFile))
+			movie.Load(movieFile);
+		else
+			ScriptInput(movie, frames);
+
+		NullBackend device;
+		MoviePlayer player(device, movie);
+		Chip8 chip(config, player);
+		chip.Seed(movie.GetSeed());
+		{
+			File rom(romFile, "rb");
+			auto buffer = rom.ReadAll<std::vector<u8>>();
+			chip.Load(buffer.data(), buffer.size());
+		}
+
+		std::stringstream ss;
+		uint frame = 0;
+		bool running = true;
+		for(uint check : CheckFrames)
+		{
+			try
+			{
+				while(running && frame < check)
+				{
+					running = chip.Tick();
+					++frame;
+				}
+			}
+			catch(const std::exception &ex)
+			{ running = false; }
+			ss << config.RomName << " " << check << " " << (frame == check? ToHex(chip.GetFramebuffer().Hash()): std::string("stopped")) << "\n";
+		}
+		return ss.str();
+	}
+
+	void Usage()
+	{
+		std::cerr << "usage: [options]\n"
+			"\t--games <dir>\t\tcheck every .ch8 in directory (default games)\n"
+			"\t--golden <file>\t\tgolden hashes (default <games>/golden.txt)\n"
+			"\t--update\t\trewrite golden hashes instead of checking\n"
+			"\t--jobs <n>\t\tworker threads (default hardware concurrency)\n"
+			"\t--seed <n>\t\tseed for roms without movie (default 0)\n";
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string gamesDir = "games", goldenFile;
+	bool update = false;
+	uint jobs = std::max(1u, std::thread::hardware_concurrency());
+	u32 seed = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--games" && hasValue)
+			gamesDir = argv[++i];
+		else if (arg == "--golden" && hasValue)
+			goldenFile = argv[++i];
+		else if (arg == "--update")
+			update = true;
+		else if (arg == "--jobs" && hasValue)
+			jobs = std::max(1ul, strtoul(argv[++i], nullptr, 0));
+		else if (arg == "--seed" && hasValue)
+			seed = strtoul(argv[++i], nullptr, 0);
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+	if (goldenFile.empty())
+		goldenFile = gamesDir + "/golden.txt";
+
+	auto roms = File::List(gamesDir, ".ch8");
+	std::vector<std::string> results(roms.size());
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> workers;
+	for(uint i = 0; i < jobs; ++i)
+		workers.emplace_back([&]()
+		{
+			for(size_t rom; (rom = next++) < roms.size(); )
+				results[rom] = RunRom(roms[rom], seed);
+		});
+	for(auto & worker : workers)
+		worker.join();
+
+	std::string actual;
+	for(auto & result : results)
+		actual += result;
+
+	if (update)
+	{
+		File file(goldenFile, "wt");
+		file.Write(actual.data(), actual.size());
+		std::cerr << "written " << roms.size() << " roms into " << goldenFile << "\n";
+		return 0;
+	}
+
+	std::map<std::string, std::string> golden;
+	{
+		File file(goldenFile, "rt");
+		auto data = file.ReadAll<std::string>();
+		std::stringstream ss(data);
+		std::string rom, frame, hash;
+		while(ss >> rom >> frame >> hash)
+			golden[rom + " " + frame] = hash;
+	}
+
+	uint failed = 0;
+	std::stringstream ss(actual);
+	std::string rom, frame, hash;
+	while(ss >> rom >> frame >> hash)
+	{
+		auto key = rom + " " + frame;
+		auto it = golden.find(key);
+		if (it == golden.end())
+			std::cerr << "MISSING " << key << ": " << hash << "\n";
+		else if (it->second != hash)
+			std::cerr << "FAILED  " << key << ": expected " << it->second << ", got " << hash << "\n";
+		else
+			continue;
+		++failed;
+	}
+
+	std::cerr << roms.size() << " roms, " << failed << " mismatches\n";
+	return failed? 1: 0;
+}
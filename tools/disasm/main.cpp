@@ -0,0 +1,132 @@
+#include <chip8/Analyzer.h>
+#include <chip8/Disassembler.h>
+#include <chip8/File.h>
+#include <chip8/Rom.h>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace chip8;
+
+namespace
+{
+	static constexpr u16 EntryPoint = 0x200;
+
+	std::string Label(const Analyzer & analyzer, u16 addr)
+	{
+		char buffer[32];
+		if (addr == EntryPoint)
+			return "main";
+		snprintf(buffer, sizeof(buffer), "%s_%04x", analyzer.IsCall(addr)? "sub": analyzer.IsCode(addr)? "label": "data", addr);
+		return buffer;
+	}
+
+	void PrintListing(const Analyzer & analyzer, const std::vector<u8> & memory)
+	{
+		std::vector<u8> row;
+		auto flush = [&](u16 addr)
+		{
+			if (row.empty())
+				return;
+			printf("\t");
+			for(size_t i = 0; i < row.size(); ++i)
+				printf("%s0x%02x", i? " ": "", row[i]);
+			printf("\t# 0x%04x\n", static_cast<u16>(addr - row.size()));
+			row.clear();
+		};
+
+		for(uint addr = analyzer.GetBegin(); addr < analyzer.GetEnd(); )
+		{
+			bool code = analyzer.IsCode(addr);
+			if (analyzer.IsLeader(addr) || analyzer.IsDataLabel(addr))
+			{
+				flush(addr);
+				printf("\n: %s\n", Label(analyzer, addr).c_str());
+			}
+
+			if (!code)
+			{
+				row.push_back(memory[addr++]);
+				if (row.size() == 8)
+					flush(addr);
+				continue;
+			}
+
+			flush(addr);
+			u16 op = memory[addr] << 8 | memory[addr + 1];
+			u16 next = memory[addr + 2] << 8 | memory[addr + 3];
+			printf("\t%-24s# 0x%04x\n", Disassemble(op, next).c_str(), addr);
+			addr += GetInstructionSize(op);
+		}
+		flush(analyzer.GetEnd());
+	}
+
+	void WriteDot(const Analyzer & analyzer, const std::string &path)
+	{
+		std::stringstream ss;
+		ss << "digraph cfg {\n\tnode [shape=box fontname=monospace];\n";
+		for(auto & entry : analyzer.GetBlocks())
+		{
+			auto & block = entry.second;
+			char node[64];
+			snprintf(node, sizeof(node), "\t\"%04x\" [label=\"%s\\n0x%04x-0x%04x%s\"];\n",
+				block.Begin, Label(analyzer, block.Begin).c_str(), block.Begin, block.End - 1, block.Dynamic? "\\ndynamic": "");
+			ss << node;
+			for(u16 succ : block.Successors)
+			{
+				char edge[32];
+				snprintf(edge, sizeof(edge), "\t\"%04x\" -> \"%04x\";\n", block.Begin, succ);
+				ss << edge;
+			}
+		}
+		ss << "}\n";
+		auto text = ss.str();
+		File file(path, "wt");
+		file.Write(text.data(), text.size());
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string romFile, dotFile;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--dot" && i + 1 < argc)
+			dotFile = argv[++i];
+		else if (arg.empty() || arg[0] == '-' || !romFile.empty())
+		{
+			romFile.clear();
+			break;
+		}
+		else
+			romFile = arg;
+	}
+
+	if (romFile.empty())
+	{
+		std::cerr << "usage: [--dot <cfg.dot>] <rom file>" << std::endl;
+		return 1;
+	}
+
+	std::vector<u8> memory(0x10000 + 4);
+	size_t size;
+	{
+		auto rom = LoadRom(romFile);
+		size = std::min<size_t>(rom.size(), 0x10000 - EntryPoint);
+		std::copy(rom.begin(), rom.begin() + size, memory.begin() + EntryPoint);
+	}
+
+	Analyzer analyzer(memory.data(), EntryPoint, EntryPoint + size);
+	analyzer.Analyze(EntryPoint);
+	PrintListing(analyzer, memory);
+	if (!dotFile.empty())
+		WriteDot(analyzer, dotFile);
+
+	uint code = 0;
+	for(uint addr = analyzer.GetBegin(); addr < analyzer.GetEnd(); ++addr)
+		if (analyzer.IsCode(addr))
+			code += analyzer.GetInstructionSize(addr);
+	std::cerr << size << " bytes, " << code << " bytes of code in " << analyzer.GetBlocks().size() << " blocks" << std::endl;
+	return 0;
+}
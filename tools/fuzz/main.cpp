@@ -0,0 +1,144 @@
+#include <chip8/Chip8.h>
+#include <chip8/Config.h>
+#include <chip8/File.h>
+#include <chip8/backend/null/NullBackend.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdlib.h>
+
+using namespace chip8;
+
+namespace
+{
+	static constexpr uint MaxSteps	= 20000;
+	static constexpr uint Slice		= 500; //invariants are checked between slices
+
+	struct Harness
+	{
+		Config		config;
+		NullBackend	backend;
+		Chip8		chip;
+
+		Harness(): chip(config, backend)
+		{
+			config.PersistFlags = false;
+			chip.SetHaltOnFault(true);
+		}
+
+		///false if interpreter state became inconsistent
+		bool Run(const u8 *data, size_t size)
+		{
+			//FX75 of an earlier input must not leak into FX85 of this one
+			config.ResetFlags();
+			chip.Load(data, size);
+			chip.Reset();
+			chip.Seed(0);
+			for(uint steps = 0; steps < MaxSteps; steps += Slice)
+			{
+				bool progress = chip.RunCycles(Slice) == Slice;
+				if (!chip.CheckInvariants())
+					return false;
+				if (!progress)
+					break;
+			}
+			return true;
+		}
+	};
+
+	Harness & GetHarness()
+	{
+		static Harness harness;
+		return harness;
+	}
+}
+
+///libFuzzer entry point, any exception or broken invariant is a bug since faults only halt
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	try
+	{
+		if (!GetHarness().Run(data, size))
+		{
+			std::cerr << "invariant check failed" << std::endl;
+			abort();
+		}
+	}
+	catch(const std::exception &ex)
+	{
+		std::cerr << "unexpected exception: " << ex.what() << std::endl;
+		abort();
+	}
+	return 0;
+}
+
+#ifndef XOMOD_LIBFUZZER
+///standalone driver: replays given inputs or runs random programs
+int main(int argc, char **argv)
+{
+	unsigned long iterations = 100000;
+	u32 seed = 0;
+	uint maxSize = 4096;
+	std::vector<std::string> inputs;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--iterations" && hasValue)
+			iterations = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--seed" && hasValue)
+			seed = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--max-size" && hasValue)
+			maxSize = strtoul(argv[++i], nullptr, 0);
+		else if (arg.empty() || arg[0] == '-')
+		{
+			std::cerr << "usage: [--iterations <n>] [--seed <n>] [--max-size <bytes>] [input files...]\n"
+				"\treplays input files if given, otherwise runs random programs" << std::endl;
+			return 1;
+		}
+		else
+			inputs.push_back(arg);
+	}
+
+	if (!inputs.empty())
+	{
+		for(auto &input : inputs)
+		{
+			File file(input, "rb");
+			auto data = file.ReadAll<std::vector<u8>>();
+			LLVMFuzzerTestOneInput(data.data(), data.size());
+			auto &chip = GetHarness().chip;
+			std::cerr << input << ": " << chip.GetInstructionCount() << " instructions, fault " << static_cast<int>(chip.GetFault()) << std::endl;
+		}
+		return 0;
+	}
+
+	using clock = std::chrono::steady_clock;
+	std::mt19937 gen(seed);
+	std::uniform_int_distribution<uint> sizeDist(2, maxSize);
+	std::vector<u8> program;
+	std::array<unsigned long, 4> faults = {};
+	u64 instructions = 0;
+
+	auto started = clock::now();
+	for(unsigned long i = 0; i < iterations; ++i)
+	{
+		program.resize(sizeDist(gen));
+		for(size_t j = 0; j < program.size(); j += 4)
+		{
+			u32 word = gen();
+			for(size_t k = j; k < j + 4 && k < program.size(); ++k, word >>= 8)
+				program[k] = word;
+		}
+		LLVMFuzzerTestOneInput(program.data(), program.size());
+		auto &chip = GetHarness().chip;
+		++faults[static_cast<size_t>(chip.GetFault())];
+		instructions += chip.GetInstructionCount();
+	}
+	double seconds = std::chrono::duration<double>(clock::now() - started).count();
+
+	std::cerr << iterations << " runs in " << seconds << "s, " << static_cast<unsigned long>(iterations / seconds) << " runs/s, " << instructions << " instructions\n"
+		"faults: none " << faults[0] << ", invalid instruction " << faults[1] << ", stack overflow " << faults[2] << ", stack underflow " << faults[3] << std::endl;
+	return 0;
+}
+#endif
@@ -0,0 +1,119 @@
+#include <chip8/Chip8.h>
+#include <chip8/Config.h>
+#include <chip8/Host.h>
+#include <chip8/Rom.h>
+#include <chip8/backend/null/NullBackend.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+using namespace chip8;
+
+namespace
+{
+	void Usage()
+	{
+		std::cerr << "usage: xomod-host [--threads n] [--instances n] [--seconds n] <roms...>\n"
+			"\truns headless instances of the given roms at 60Hz, multiplexed onto a few threads\n";
+	}
+
+	///headless backend which quits once asked to
+	class StoppableBackend : public NullBackend
+	{
+		const std::atomic<bool> &_stop;
+
+	public:
+		StoppableBackend(const std::atomic<bool> &stop): _stop(stop) { }
+
+		bool ProcessEvents(Framebuffer & fb) override
+		{ return !_stop; }
+	};
+
+	struct Instance
+	{
+		Config				config;
+		StoppableBackend	backend;
+		Chip8				chip;
+
+		Instance(const std::atomic<bool> &stop): backend(stop), chip(config, backend)
+		{
+			config.PersistFlags = false;
+			chip.SetHaltOnFault(true);
+		}
+	};
+}
+
+int main(int argc, char **argv)
+{
+	uint threads = std::thread::hardware_concurrency(), instances = 0, seconds = 10;
+	std::vector<std::string> roms;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--threads" && hasValue)
+			threads = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--instances" && hasValue)
+			instances = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--seconds" && hasValue)
+			seconds = strtoul(argv[++i], nullptr, 0);
+		else if (arg.empty() || arg[0] == '-')
+		{
+			Usage();
+			return 1;
+		}
+		else
+			roms.push_back(arg);
+	}
+
+	if (roms.empty())
+	{
+		Usage();
+		return 1;
+	}
+	if (!instances)
+		instances = roms.size();
+
+	std::atomic<bool> stop(false);
+	std::vector<std::unique_ptr<Instance>> chips;
+	for(uint i = 0; i < instances; ++i)
+	{
+		auto &romFile = roms[i % roms.size()];
+		auto buffer = LoadRom(romFile);
+		std::unique_ptr<Instance> instance(new Instance(stop));
+		instance->chip.Load(buffer.data(), buffer.size());
+		instance->config.LoadRomConfig(romFile);
+		instance->config.Core.Turbo = false;
+		instance->chip.Seed(i);
+		chips.push_back(std::move(instance));
+	}
+
+	auto started = std::chrono::steady_clock::now();
+	{
+		Host host(threads);
+		for(auto &instance : chips)
+			host.Add(instance->chip);
+
+		std::this_thread::sleep_for(std::chrono::seconds(seconds));
+		stop = true;
+		host.Wait();
+
+		auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+		auto stats = host.GetStats();
+		u64 instructions = 0;
+		for(auto &instance : chips)
+			instructions += instance->chip.GetInstructionCount();
+		std::cout << instances << " instances on " << (threads? threads: 1) << " threads, "
+			<< stats.Frames << " frames in " << elapsed << "s ("
+			<< stats.Frames / elapsed / instances << " fps per instance), "
+			<< instructions << " instructions, "
+			<< stats.MissedTicks << " missed ticks, "
+			<< stats.Faults << " faulted\n";
+	}
+	return 0;
+}
@@ -0,0 +1,246 @@
+#include <chip8/Analyzer.h>
+#include <chip8/Disassembler.h>
+#include <chip8/File.h>
+#include <chip8/Rom.h>
+#include <chip8/Memory.h>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <stdio.h>
+
+using namespace chip8;
+
+namespace
+{
+	static constexpr u16 EntryPoint = 0x200;
+
+	enum class Kind
+	{
+		Inline,		//translated to C++
+		Jump,
+		Call,
+		Skip,
+		Interpret,	//interpreter, no control flow or code changes
+		Leave		//interpreter, may change control flow, halt, wait or write memory
+	};
+
+	Kind Classify(u16 op)
+	{
+		u8 nn = op & 0xff, z = op & 0x0f;
+		switch(op >> 12)
+		{
+		case 0x0:
+			switch(op)
+			{
+			case 0x0000: case 0x00ee: case 0x00fd:
+				return Kind::Leave;
+			default:
+				return Kind::Interpret;
+			}
+		case 0x1:	return Kind::Jump;
+		case 0x2:	return Kind::Call;
+		case 0x3: case 0x4: case 0x9:
+			return Kind::Skip;
+		case 0x5:
+			return z == 0? Kind::Skip: z == 2? Kind::Leave: Kind::Interpret;
+		case 0x6: case 0x7: case 0x8: case 0xa:
+			return Kind::Inline;
+		case 0xb:	return Kind::Leave;
+		case 0xc: case 0xd:
+			return Kind::Interpret;
+		case 0xe:	return Kind::Skip;
+		default:
+			if (op == 0xf000)
+				return Kind::Inline;
+			switch(nn)
+			{
+			case 0x07: case 0x15: case 0x1e: case 0x29: case 0x30:
+				return Kind::Inline;
+			case 0x0a: case 0x33: case 0x55:
+				return Kind::Leave;
+			default:
+				return Kind::Interpret;
+			}
+		}
+	}
+
+	std::string Hex(uint value, uint digits = 4)
+	{
+		char buffer[16];
+		snprintf(buffer, sizeof(buffer), "0x%0*x", digits, value);
+		return buffer;
+	}
+
+	std::string Inline(u16 op, u16 next)
+	{
+		std::string x = "V[" + std::to_string((op >> 8) & 0x0f) + "]";
+		std::string y = "V[" + std::to_string((op >> 4) & 0x0f) + "]";
+		std::string nn = Hex(op & 0xff, 2);
+		switch(op >> 12)
+		{
+		case 0x6:	return x + " = " + nn + ";";
+		case 0x7:	return x + " += " + nn + ";";
+		case 0xa:	return "c.I = " + Hex(op & 0x0fff) + ";";
+		case 0x8:
+			switch(op & 0x0f)
+			{
+			case 0x0:	return x + " = " + y + ";";
+			case 0x1:	return x + " |= " + y + ";";
+			case 0x2:	return x + " &= " + y + ";";
+			case 0x3:	return x + " ^= " + y + ";";
+			case 0x4:	return "{ uint r = " + x + " + " + y + "; " + x + " = r; V[15] = r > 0xff; }";
+			case 0x5:	return "{ u8 f = " + x + " >= " + y + "; " + x + " = " + x + " - " + y + "; V[15] = f; }";
+			case 0x7:	return "{ u8 f = " + y + " >= " + x + "; " + x + " = " + y + " - " + x + "; V[15] = f; }";
+			case 0x6:	return "{ u8 s = c.ShiftQuirk? " + x + ": " + y + "; " + x + " = s >> 1; V[15] = s & 1; }";
+			case 0xe:	return "{ u8 s = c.ShiftQuirk? " + x + ": " + y + "; " + x + " = s << 1; V[15] = (s & 0x80) != 0; }";
+			default:	return ";";
+			}
+		default:
+			if (op == 0xf000)
+				return "c.I = " + Hex(next) + ";";
+			switch(op & 0xff)
+			{
+			case 0x07:	return x + " = c.Delay; c.DelayRead = true;";
+			case 0x15:	return "c.Delay = " + x + ";";
+			case 0x1e:	return "c.I += " + x + ";";
+			case 0x29:	return "c.I = " + std::to_string(Memory::FontOffset) + " + (" + x + " & 0xf) * 5;";
+			case 0x30:	return "c.I = " + std::to_string(Memory::BigFontOffset) + " + (" + x + " & 0xf) * 10;";
+			}
+		}
+		throw std::logic_error("instruction can't be inlined: " + Hex(op));
+	}
+
+	std::string SkipCondition(u16 op)
+	{
+		std::string x = "V[" + std::to_string((op >> 8) & 0x0f) + "]";
+		std::string y = "V[" + std::to_string((op >> 4) & 0x0f) + "]";
+		switch(op >> 12)
+		{
+		case 0x3:	return x + " == " + Hex(op & 0xff, 2);
+		case 0x4:	return x + " != " + Hex(op & 0xff, 2);
+		case 0x5:	return x + " == " + y;
+		case 0x9:	return x + " != " + y;
+		default:	return (op & 0xff) == 0x9e? "c.Key(" + x + ")": "!c.Key(" + x + ")";
+		}
+	}
+
+	std::string BaseName(const std::string &path)
+	{
+		auto slash = path.rfind('/');
+		auto name = slash == path.npos? path: path.substr(slash + 1);
+		return name.substr(0, name.rfind('.'));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		std::cerr << "usage: <rom file> <output.cpp>" << std::endl;
+		return 1;
+	}
+	std::string romFile = argv[1], outputFile = argv[2];
+
+	std::vector<u8> memory(0x10000 + 4);
+	size_t size;
+	{
+		auto rom = LoadRom(romFile);
+		size = std::min<size_t>(rom.size(), 0x10000 - EntryPoint);
+		std::copy(rom.begin(), rom.begin() + size, memory.begin() + EntryPoint);
+	}
+	auto read16 = [&memory](uint addr) -> u16 { return memory[addr] << 8 | memory[addr + 1]; };
+
+	Analyzer analyzer(memory.data(), EntryPoint, EntryPoint + size);
+	analyzer.Analyze(EntryPoint);
+
+	//every analyzer block starts a static block, as does every instruction following the one leaving to interpreter
+	std::set<uint> entries;
+	for(auto & block : analyzer.GetBlocks())
+		entries.insert(block.first);
+	for(uint addr = EntryPoint; addr < EntryPoint + size; ++addr)
+		if (analyzer.IsCode(addr) && Classify(read16(addr)) == Kind::Leave)
+		{
+			uint next = addr + GetInstructionSize(read16(addr));
+			if (next < 0x10000 && analyzer.IsCode(next))
+				entries.insert(next);
+		}
+
+	std::stringstream blocks, table;
+	for(uint entry : entries)
+	{
+		uint addr = entry, count = 0, end;
+		std::stringstream code;
+		while(true)
+		{
+			u16 op = read16(addr), arg = read16(addr + 2);
+			uint next = addr + GetInstructionSize(op);
+			end = next;
+			++count;
+			code << "\t\t//" << Hex(addr) << ": " << Disassemble(op, arg) << "\n";
+			auto leave = [&](const std::string &pc) { code << "\t\tc.PC = " << pc << ";\n\t\treturn " << count << ";\n"; };
+
+			bool last = true;
+			switch(Classify(op))
+			{
+			case Kind::Inline:
+				code << "\t\t" << Inline(op, arg) << "\n";
+				last = false;
+				break;
+			case Kind::Jump:
+				leave(Hex(op & 0x0fff));
+				break;
+			case Kind::Call:
+				code << "\t\tc.Call(" << Hex(next) << ", " << Hex(op & 0x0fff) << ");\n\t\treturn " << count << ";\n";
+				break;
+			case Kind::Skip:
+				{
+					//skipped instruction size is part of the compiled block
+					uint skip = next + GetInstructionSize(read16(next));
+					end = next + 2;
+					leave("(" + SkipCondition(op) + ")? " + Hex(skip) + ": " + Hex(next));
+				}
+				break;
+			case Kind::Interpret:
+				code << "\t\tc.Interpret(" << Hex(addr) << ");\n";
+				last = false;
+				break;
+			case Kind::Leave:
+				code << "\t\tc.Interpret(" << Hex(addr) << ");\n\t\treturn " << count << ";\n";
+				break;
+			}
+
+			if (!last && (next >= 0x10000 || !analyzer.IsCode(next) || entries.count(next)))
+			{
+				leave(Hex(next));
+				last = true;
+			}
+			if (last)
+				break;
+			addr = next;
+		}
+		auto body = code.str();
+		blocks << "\tuint Block_" << Hex(entry).substr(2) << "(StaticContext &c)\n\t{\n"
+			<< (body.find("V[") != body.npos? "\t\tu8 * const V = c.V;\n": "") << body << "\t}\n\n";
+		table << "\t\t{ " << Hex(entry) << ", " << Hex(std::min<uint>(end, 0xffff)) << ", " << count << ", &Block_" << Hex(entry).substr(2) << " },\n";
+	}
+
+	std::stringstream ss;
+	ss << "//generated by xomod-recompile from " << BaseName(romFile) << ", do not edit\n"
+		<< "#include <chip8/StaticProgram.h>\n\n"
+		<< "namespace\n{\n\tusing namespace chip8;\n\n"
+		<< "\tconst u8 Rom[] =\n\t{";
+	for(size_t i = 0; i < size; ++i)
+		ss << (i % 16? " ": "\n\t\t") << Hex(memory[EntryPoint + i], 2) << ",";
+	ss << "\n\t};\n\n"
+		<< blocks.str()
+		<< "\tconst StaticBlock Blocks[] =\n\t{\n" << table.str() << "\t};\n\n"
+		<< "\tconst StaticProgram Program = { \"" << BaseName(romFile) << "\", Rom, sizeof(Rom), Blocks, sizeof(Blocks) / sizeof(Blocks[0]) };\n"
+		<< "\tStaticProgram::Registrar Registrar(Program);\n"
+		<< "}\n";
+
+	auto text = ss.str();
+	File file(outputFile, "wt");
+	file.Write(text.data(), text.size());
+	std::cerr << BaseName(romFile) << ": " << entries.size() << " blocks" << std::endl;
+	return 0;
+}
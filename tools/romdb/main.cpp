@@ -0,0 +1,77 @@
+#include <chip8/Config.h>
+#include <chip8/File.h>
+#include <chip8/Rom.h>
+#include <chip8/RomDatabase.h>
+#include <iostream>
+#include <map>
+
+using namespace chip8;
+
+namespace
+{
+	///rom next to ini file, binary preferred over source
+	std::string FindRom(const std::string &ini)
+	{
+		auto prefix = ini.substr(0, ini.size() - 4);
+		for(auto ext : { ".ch8", ".8o", ".o8" })
+			if (File::Exists(prefix + ext))
+				return prefix + ext;
+		return std::string();
+	}
+}
+
+int main(int argc, char **argv)
+{
+	std::string output = RomDatabase::GetDefaultPath();
+	std::vector<std::string> dirs;
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--output" && i + 1 < argc)
+			output = argv[++i];
+		else if (arg.empty() || arg[0] == '-')
+		{
+			dirs.clear();
+			break;
+		}
+		else
+			dirs.push_back(arg);
+	}
+
+	if (dirs.empty())
+	{
+		std::cerr << "usage: [--output <file>] <directory with roms and ini files>..." << std::endl;
+		return 1;
+	}
+
+	std::map<u64, std::string> names;
+	std::vector<RomDatabase::Record> records;
+	for(auto &dir : dirs)
+		for(auto &ini : File::List(dir, ".ini"))
+		{
+			auto romFile = FindRom(ini);
+			if (romFile.empty())
+			{
+				std::cerr << "skipping " << ini << ": no rom" << std::endl;
+				continue;
+			}
+
+			auto rom = LoadRom(romFile);
+			u64 hash = RomDatabase::HashRom(rom.data(), rom.size());
+			auto known = names.find(hash);
+			if (known != names.end())
+			{
+				std::cerr << "skipping " << romFile << ": same contents as " << known->second << std::endl;
+				continue;
+			}
+
+			Config config;
+			config.LoadRomConfig(romFile);
+			names[hash] = romFile;
+			records.push_back(RomDatabase::MakeRecord(hash, config));
+		}
+
+	RomDatabase::Save(output, records);
+	std::cerr << records.size() << " roms written to " << output << std::endl;
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include <chip8/backend/shm/ShmBackend.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdlib.h>
+#include <thread>
+
+using namespace chip8;
+
+namespace
+{
+	void Usage()
+	{
+		std::cerr << "usage: xomod-shm [--keys mask] [--frames n] <name>\n"
+			"\tprints frames published by xomod --shm <name>, holding keys from hex mask while running\n";
+	}
+
+	u32 Hash(const ShmFrame &frame)
+	{
+		u32 hash = 2166136261u;
+		for(uint i = 0, n = frame.Width * frame.Height; i < n; ++i)
+			hash = (hash ^ frame.Pixels[i]) * 16777619u;
+		return hash;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	uint frames = 0;
+	u16 keys = 0;
+	std::string name;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--keys" && hasValue)
+			keys = strtoul(argv[++i], nullptr, 16);
+		else if (arg == "--frames" && hasValue)
+			frames = strtoul(argv[++i], nullptr, 0);
+		else if (arg.empty() || arg[0] == '-' || !name.empty())
+		{
+			Usage();
+			return 1;
+		}
+		else
+			name = arg;
+	}
+
+	if (name.empty())
+	{
+		Usage();
+		return 1;
+	}
+
+	try
+	{
+		ShmReader reader(name);
+		reader.SetKeys(keys);
+
+		std::unique_ptr<ShmFrame> frame(new ShmFrame());
+		u32 last = 0;
+		bool first = true;
+		for(uint printed = 0; !frames || printed < frames; )
+		{
+			u32 number = reader.Read(*frame);
+			if (first || number != last)
+			{
+				std::cout << "frame " << number << " " << uint(frame->Width) << "x" << uint(frame->Height)
+					<< " keys " << std::hex << std::setfill('0') << std::setw(4) << frame->Keys
+					<< " pixels " << std::setw(8) << Hash(*frame) << std::dec
+					<< (frame->Buzzer? " buzzer": "") << std::endl;
+				first = false;
+				last = number;
+				++printed;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		reader.SetKeys(0);
+	}
+	catch(const std::exception &ex)
+	{
+		std::cerr << "error: " << ex.what() << "\n";
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,50 @@
+#include <chip8/Disassembler.h>
+#include <chip8/Tracer.h>
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace chip8;
+
+int main(int argc, char **argv)
+{
+	std::string traceFile;
+	unsigned long from = 0, count = 0;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+		if (arg == "--from" && hasValue)
+			from = strtoul(argv[++i], nullptr, 0);
+		else if (arg == "--count" && hasValue)
+			count = strtoul(argv[++i], nullptr, 0);
+		else if (arg.empty() || arg[0] == '-' || !traceFile.empty())
+		{
+			traceFile.clear();
+			break;
+		}
+		else
+			traceFile = arg;
+	}
+
+	if (traceFile.empty())
+	{
+		std::cerr << "usage: [--from <n>] [--count <n>] <trace file>" << std::endl;
+		return 1;
+	}
+
+	auto records = Tracer::Load(traceFile);
+	size_t end = count? std::min<size_t>(records.size(), from + count): records.size();
+	for(size_t index = from; index < end; ++index)
+	{
+		auto & r = records[index];
+		//long assignment operand is not recorded, but it ends up in i
+		auto text = Disassemble(r.Op, r.I);
+		printf("%04x: %04x %-24s ; i = 0x%04x", r.PC, r.Op, text.c_str(), r.I);
+		if (r.Reg != TraceRecord::NoRegister)
+			printf(", v%x = 0x%02x", r.Reg, r.Value);
+		printf("\n");
+	}
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include <chip8/Audio.h>
+#include <chip8/Config.h>
+#include <chip8/Framebuffer.h>
+#include <chip8/Memory.h>
+#include <chip8/backend/sdl2/SDL2Backend.h>
+#include <chip8/backend/stream/Stream.h>
+#include <iostream>
+#include <poll.h>
+
+using namespace chip8;
+
+namespace
+{
+	static constexpr int FrameMs = 1000 / 60;
+
+	void Usage()
+	{
+		std::cerr << "usage: xomod-viewer <unix:path | [host:]port>\n"
+			"\tshows emulator started with --stream and sends keys back\n";
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 2)
+	{
+		Usage();
+		return 1;
+	}
+
+	try
+	{
+		stream::Connection connection(stream::Connect(argv[1]));
+
+		//buzzer pattern is placed at address 0 of a private memory and played by local audio
+		Memory memory;
+		Audio audio(memory);
+		Config config;
+		SDL2Backend backend(config);
+		Framebuffer fb;
+
+		u16 keys = 0;
+		bool running = true;
+		while(running)
+		{
+			pollfd pfd = { connection.GetFd(), POLLIN, 0 };
+			poll(&pfd, 1, FrameMs);
+
+			bool open = connection.Receive([&](stream::Message type, const u8 *payload, size_t size) {
+				switch(type)
+				{
+				case stream::Message::Frame:
+					stream::DecodeFrame(fb, payload, size);
+					break;
+				case stream::Message::Buzzer:
+					if (size == 1 + Audio::PatternSize)
+					{
+						backend.SetAudio(nullptr);
+						for(uint i = 0; i < Audio::PatternSize; ++i)
+							memory.Set(i, payload[1 + i]);
+						audio.SetBaseAddr(0);
+						backend.SetAudio(payload[0]? &audio: nullptr);
+					}
+					break;
+				default:
+					break;
+				}
+			});
+			if (!open)
+			{
+				std::cerr << "connection closed\n";
+				break;
+			}
+
+			running = backend.ProcessEvents(fb) && backend.Render(fb);
+
+			for(u8 key = 0; key < 16; ++key)
+			{
+				bool pressed = backend.GetKeyState(key);
+				if (pressed == bool(keys & (1 << key)))
+					continue;
+				keys ^= 1 << key;
+				u8 event[2] = { key, pressed };
+				connection.Send(stream::Message::Key, event, sizeof(event));
+			}
+			if (!connection.Flush())
+			{
+				std::cerr << "connection lost\n";
+				break;
+			}
+		}
+	}
+	catch(const std::exception &ex)
+	{
+		std::cerr << "error: " << ex.what() << "\n";
+		return 1;
+	}
+	return 0;
+}